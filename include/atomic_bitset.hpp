@@ -0,0 +1,214 @@
+/// @file atomic_bitset.hpp
+/// @brief A bitset that threads can claim bits of without a lock
+
+#ifndef ATOMIC_BITSET_H_
+#define ATOMIC_BITSET_H_
+
+#include "better_bitset.hpp"
+
+// STL includes
+#include <atomic>
+
+namespace better_bitset
+{
+    /// @brief A bitset of atomic chunks, so that any number of threads can
+    /// claim and release bits concurrently. Every operation on a single bit
+    /// is atomic, while operations that read several chunks, such as count,
+    /// see each chunk at a possibly different point in time
+    template<size_t N> requires (N > 0)
+        class AtomicBitSet
+    {
+    private:
+        /// @brief The mask of the last bit
+        constexpr static uint64_t LAST_MASK = ~(~1ull << ((N - 1ull) % (64ull)));
+        /// @brief The number of chunks stored
+        constexpr static size_t NUM_CHUNKS = (N + 63) / 64;
+        /// @brief The storage type. Bits are stored from LSB to MSB
+        /// and populate lower order storage positions first
+        using Storage_t = std::array<std::atomic<uint64_t>, NUM_CHUNKS>;
+
+        /// @param chunk The chunk index
+        /// @return The mask of the bits of a chunk that are below N
+        constexpr static uint64_t valid_bits(size_t chunk) noexcept
+        {
+            return chunk == NUM_CHUNKS - 1 ? LAST_MASK : ~0ull;
+        }
+    public:
+        AtomicBitSet() noexcept : m_storage() {}
+        /// @param bits The bits to copy
+        explicit AtomicBitSet(const BitSet<N>& bits) noexcept : m_storage()
+        {
+            for (size_t chunk = 0; chunk < NUM_CHUNKS; ++chunk)
+                m_storage[chunk].store(bits.storage()[chunk], std::memory_order_relaxed);
+        }
+        AtomicBitSet(const AtomicBitSet&) = delete;
+        AtomicBitSet& operator=(const AtomicBitSet&) = delete;
+
+        /* ACCESSORS */
+
+        /// @brief Counts the 1 bits with relaxed loads. Only exact while no
+        /// other thread modifies the set
+        /// @return The number of 1 bits
+        size_t count() const noexcept
+        {
+            size_t result = 0;
+            for (const std::atomic<uint64_t>& chunk : m_storage)
+                result += std::popcount(chunk.load(std::memory_order_relaxed));
+            return result;
+        }
+        /// @brief Tests the bit at a an index. Does not perform a bounds
+        /// check in release
+        /// @param pos The bit position
+        /// @return The bit's value
+        bool test(size_t pos) const noexcept
+        {
+            BITSET_ASSERT(pos < N);
+            return (m_storage[pos / 64].load(std::memory_order_acquire) >> (pos % 64)) & 0x1;
+        }
+        /// @return A copy of the bits, read chunk by chunk
+        BitSet<N> load() const noexcept
+        {
+            using Chunks_t = std::remove_cvref_t<decltype(BitSet<N>().storage())>;
+            Chunks_t chunks;
+            for (size_t chunk = 0; chunk < NUM_CHUNKS; ++chunk)
+                chunks[chunk] = static_cast<typename Chunks_t::value_type>(
+                    m_storage[chunk].load(std::memory_order_acquire));
+            if constexpr (N > 64)
+                return BitSet<N>(chunks);
+            else
+                return BitSet<N>(chunks[0]);
+        }
+
+        /* CAPACITY */
+
+        constexpr size_t size() const noexcept { return N; }
+
+        /* MODIFIERS */
+
+        /// @brief Atomically sets the bit at pos to value
+        AtomicBitSet& set(size_t pos, bool value = true) noexcept
+        {
+            BITSET_ASSERT(pos < N);
+            if (value == false)
+                return reset(pos);
+            m_storage[pos / 64].fetch_or(1ull << (pos % 64), std::memory_order_acq_rel);
+            return *this;
+        }
+        /// @brief Atomically sets the bit at pos to 0
+        AtomicBitSet& reset(size_t pos) noexcept
+        {
+            BITSET_ASSERT(pos < N);
+            m_storage[pos / 64].fetch_and(~(1ull << (pos % 64)), std::memory_order_acq_rel);
+            return *this;
+        }
+        /// @brief Finds the first zero and sets it to 1
+        /// @return The position of the claimed bit, or N if all bits are set
+        size_t claim_first_zero() noexcept
+        {
+            size_t chunk;
+            const uint64_t claimed = claim_word(1, chunk);
+            return claimed == 0 ? N : chunk * 64 + std::countr_zero(claimed);
+        }
+        /// @brief Sets up to max of the lowest zeros of the first chunk that
+        /// is not full to 1. The bits are set with a compare-exchange, which
+        /// is retried with the fresh value if another thread changed the
+        /// chunk, and full chunks are skipped
+        /// @param max The largest number of bits to claim, from 1 to 64
+        /// @param chunk Set to the index of the chunk the bits were claimed
+        /// from
+        /// @return The claimed bits of the chunk, or 0 if all bits are set
+        uint64_t claim_word(size_t max, size_t& chunk) noexcept
+        {
+            BITSET_ASSERT(max > 0 && max <= 64);
+            for (chunk = 0; chunk < NUM_CHUNKS; ++chunk)
+            {
+                const uint64_t valid = valid_bits(chunk);
+                uint64_t bits = m_storage[chunk].load(std::memory_order_relaxed);
+                while ((~bits & valid) != 0)
+                {
+                    // valid is a prefix, so the lowest zero is always valid
+                    const uint64_t claimed = max == 1 ? ~bits & (bits + 1) :
+                        detail::lowest_ones(~bits & valid, max);
+                    if (m_storage[chunk].compare_exchange_weak(bits, bits | claimed,
+                        std::memory_order_acquire, std::memory_order_relaxed))
+                        return claimed;
+                }
+            }
+            return 0;
+        }
+        /// @brief Sets a bit claimed by claim_first_zero back to 0. Writes
+        /// made by the releasing thread are visible to the thread that
+        /// claims the bit next
+        /// @param pos The bit position
+        void release(size_t pos) noexcept
+        {
+            BITSET_ASSERT(pos < N);
+            release_mask(pos / 64, 1ull << (pos % 64));
+        }
+        /// @brief Sets claimed bits of a chunk back to 0 in one atomic
+        /// operation
+        /// @param chunk The chunk index
+        /// @param mask The bits to release
+        void release_mask(size_t chunk, uint64_t mask) noexcept
+        {
+            BITSET_ASSERT(chunk < NUM_CHUNKS);
+            const uint64_t old = m_storage[chunk].fetch_and(~mask, std::memory_order_release);
+            BITSET_ASSERT((old & mask) == mask);
+        }
+        /// @brief Finds the first run of k zeros and sets it to 1, one chunk
+        /// at a time with a compare-exchange. If another thread claims a bit
+        /// of the run first, the chunks already set are released again and
+        /// the search restarts
+        /// @param k The length of the run, at least 1
+        /// @return The position where the claimed run starts, or N if there
+        /// is none
+        size_t claim_run(size_t k) noexcept
+        {
+            BITSET_ASSERT(k > 0);
+            if (k > N)
+                return N;
+            for (;;)
+            {
+                const size_t pos = detail::find_run(NUM_CHUNKS, k, [this](size_t chunk) {
+                    return ~m_storage[chunk].load(std::memory_order_relaxed) & valid_bits(chunk);
+                });
+                if (pos >= N)
+                    return N;
+                size_t claimed = 0;
+                const bool complete = detail::for_each_word_mask(pos, k, [&](size_t chunk, uint64_t mask) {
+                    uint64_t bits = m_storage[chunk].load(std::memory_order_relaxed);
+                    while ((bits & mask) == 0)
+                    {
+                        if (m_storage[chunk].compare_exchange_weak(bits, bits | mask,
+                            std::memory_order_acquire, std::memory_order_relaxed))
+                        {
+                            claimed += std::popcount(mask);
+                            return true;
+                        }
+                    }
+                    return false;
+                });
+                if (complete)
+                    return pos;
+                release_range(pos, claimed);
+            }
+        }
+        /// @brief Sets a run claimed by claim_run back to 0, with one atomic
+        /// operation per chunk
+        /// @param pos The position where the run starts
+        /// @param k The length of the run
+        void release_range(size_t pos, size_t k) noexcept
+        {
+            BITSET_ASSERT(pos + k <= N);
+            detail::for_each_word_mask(pos, k, [this](size_t chunk, uint64_t mask) {
+                release_mask(chunk, mask);
+                return true;
+            });
+        }
+    private:
+        /// @brief The internal value
+        Storage_t m_storage;
+    };
+}
+
+#endif
@@ -0,0 +1,231 @@
+/// @file atomic_hierarchical_bitset.hpp
+/// @brief A lock-free slot allocator with summary levels for large sizes
+
+#ifndef ATOMIC_HIERARCHICAL_BITSET_H_
+#define ATOMIC_HIERARCHICAL_BITSET_H_
+
+#include "hierarchical_bitset.hpp"
+
+// STL includes
+#include <atomic>
+
+namespace better_bitset
+{
+    /// @brief A bitset of atomic chunks with 64-ary summaries of which chunks
+    /// may contain a zero, so that threads can claim and release bits
+    /// concurrently in one compare-exchange plus one atomic operation per
+    /// summary level. The summaries are hints: a set bit may lead to a full
+    /// chunk, which the claiming thread then clears before retrying, but a
+    /// chunk with a zero always has its bit set once no operation is in
+    /// flight
+    template<size_t N> requires (N > 0)
+        class AtomicHierarchicalBitSet
+    {
+    private:
+        /// @brief The mask of the last bit
+        constexpr static uint64_t LAST_MASK = ~(~1ull << ((N - 1ull) % (64ull)));
+        /// @brief The number of chunks stored
+        constexpr static size_t NUM_CHUNKS = (N + 63) / 64;
+        /// @brief The summary level layout
+        using Levels = detail::SummaryLevels<NUM_CHUNKS>;
+        /// @brief The storage type. Bits are stored from LSB to MSB
+        /// and populate lower order storage positions first. Bits past N
+        /// are always 1, so that they are never claimed
+        using Storage_t = std::array<std::atomic<uint64_t>, NUM_CHUNKS>;
+        /// @brief The summary storage type
+        using Summary_t = std::array<std::atomic<uint64_t>, Levels::SIZE>;
+
+        /// @param level The summary level
+        /// @param index The bit index in the level
+        /// @return True if the chunk (or summary word) below a summary bit
+        /// has a zero (or a set bit)
+        bool has_free(size_t level, size_t index) const noexcept
+        {
+            if (level == 0)
+                return m_storage[index].load(std::memory_order_acquire) != ~0ull;
+            return m_free[Levels::OFFSETS[level - 1] + index].load(std::memory_order_acquire) != 0;
+        }
+        /// @brief Sets a summary bit, and the bits above it for every word
+        /// that was empty before
+        /// @param level The summary level
+        /// @param index The bit index in the level
+        void mark_free(size_t level, size_t index) noexcept
+        {
+            for (; level < Levels::NUM_LEVELS; ++level, index /= 64)
+            {
+                const uint64_t bit = 1ull << (index % 64);
+                if (m_free[Levels::OFFSETS[level] + index / 64].fetch_or(bit, std::memory_order_acq_rel) != 0)
+                    return;
+            }
+        }
+        /// @brief Clears a summary bit, and the bits above it for every word
+        /// that becomes empty. As a release may race with this, the
+        /// chunk (or word) below is checked again after each clear, and the
+        /// bit set again if it has gained a zero
+        /// @param level The summary level
+        /// @param index The bit index in the level
+        void mark_full(size_t level, size_t index) noexcept
+        {
+            for (; level < Levels::NUM_LEVELS; ++level, index /= 64)
+            {
+                const uint64_t bit = 1ull << (index % 64);
+                const uint64_t old = m_free[Levels::OFFSETS[level] + index / 64].fetch_and(~bit,
+                    std::memory_order_acq_rel);
+                if (has_free(level, index))
+                    return mark_free(level, index);
+                if ((old & ~bit) != 0)
+                    return;
+            }
+        }
+    public:
+        AtomicHierarchicalBitSet() noexcept : m_storage(), m_free()
+        {
+            m_storage[NUM_CHUNKS - 1].store(~LAST_MASK, std::memory_order_relaxed);
+            // every chunk, and so every summary word, starts out with a zero
+            size_t children = NUM_CHUNKS;
+            for (size_t level = 0; level < Levels::NUM_LEVELS; ++level)
+            {
+                for (size_t index = 0; index < children; ++index)
+                    m_free[Levels::OFFSETS[level] + index / 64].fetch_or(1ull << (index % 64),
+                        std::memory_order_relaxed);
+                children = (children + 63) / 64;
+            }
+        }
+        AtomicHierarchicalBitSet(const AtomicHierarchicalBitSet&) = delete;
+        AtomicHierarchicalBitSet& operator=(const AtomicHierarchicalBitSet&) = delete;
+
+        /* ACCESSORS */
+
+        /// @brief Counts the 1 bits with relaxed loads. Only exact while no
+        /// other thread modifies the set
+        /// @return The number of 1 bits
+        size_t count() const noexcept
+        {
+            size_t result = 0;
+            for (const std::atomic<uint64_t>& chunk : m_storage)
+                result += std::popcount(chunk.load(std::memory_order_relaxed));
+            return result - std::popcount(~LAST_MASK);
+        }
+        /// @brief Tests the bit at a an index. Does not perform a bounds
+        /// check in release
+        /// @param pos The bit position
+        /// @return The bit's value
+        bool test(size_t pos) const noexcept
+        {
+            BITSET_ASSERT(pos < N);
+            return (m_storage[pos / 64].load(std::memory_order_acquire) >> (pos % 64)) & 0x1;
+        }
+
+        /* CAPACITY */
+
+        constexpr size_t size() const noexcept { return N; }
+
+        /* MODIFIERS */
+
+        /// @brief Finds the first zero at or after the chunk of hint and sets
+        /// it to 1. Threads that pass different hints, for instance their
+        /// thread index times N divided by the number of threads, start in
+        /// different chunks and so do not contend on the same cache line
+        /// @param hint The bit position to start searching from, below N
+        /// @return The position of the claimed bit, or N if all bits are set
+        size_t claim_first_zero(size_t hint = 0) noexcept
+        {
+            size_t chunk;
+            const uint64_t claimed = claim_word(1, chunk, hint);
+            return claimed == 0 ? N : chunk * 64 + std::countr_zero(claimed);
+        }
+        /// @brief Follows the summary bits down to a chunk with a zero and
+        /// sets up to max of its lowest zeros with a compare-exchange. Each
+        /// level takes the nearest set bit at or after the path to the chunk
+        /// of hint, wrapping around to the lowest set bit of the word, so
+        /// that a hint of 0 finds the first chunk with a zero. Stale summary
+        /// bits met on the way are cleared and the descent retried
+        /// @param max The largest number of bits to claim, from 1 to 64
+        /// @param chunk Set to the index of the chunk the bits were claimed
+        /// from
+        /// @param hint The bit position to start searching from, below N
+        /// @return The claimed bits of the chunk, or 0 if all bits are set
+        uint64_t claim_word(size_t max, size_t& chunk, size_t hint = 0) noexcept
+        {
+            BITSET_ASSERT(max > 0 && max <= 64);
+            BITSET_ASSERT(hint < N);
+            const size_t hint_chunk = std::min(hint, N - 1) / 64;
+            for (;;)
+            {
+                size_t index = 0;
+                size_t level = Levels::NUM_LEVELS;
+                // whether the descent is still on the path to the hint chunk
+                bool on_path = true;
+                for (; level > 0; --level)
+                {
+                    const uint64_t word = m_free[Levels::OFFSETS[level - 1] + index].load(std::memory_order_acquire);
+                    if (word == 0)
+                        break;
+                    uint64_t candidates = word;
+                    if (on_path)
+                    {
+                        const size_t digit = (hint_chunk >> (6 * (level - 1))) % 64;
+                        const uint64_t after = word & (~0ull << digit);
+                        if (after != 0)
+                            candidates = after;
+                        on_path = static_cast<size_t>(std::countr_zero(candidates)) == digit;
+                    }
+                    index = index * 64 + std::countr_zero(candidates);
+                }
+                if (level == Levels::NUM_LEVELS)
+                    return 0;
+                if (level > 0)
+                {
+                    // the bit above the empty word is stale
+                    mark_full(level, index);
+                    continue;
+                }
+                std::atomic<uint64_t>& word = m_storage[index];
+                uint64_t bits = word.load(std::memory_order_relaxed);
+                while (bits != ~0ull)
+                {
+                    const uint64_t claimed = max == 1 ? ~bits & (bits + 1) :
+                        detail::lowest_ones(~bits, max);
+                    if (word.compare_exchange_weak(bits, bits | claimed,
+                        std::memory_order_acq_rel, std::memory_order_relaxed))
+                    {
+                        if ((bits | claimed) == ~0ull)
+                            mark_full(0, index);
+                        chunk = index;
+                        return claimed;
+                    }
+                }
+                mark_full(0, index);
+            }
+        }
+        /// @brief Sets a bit claimed by claim_first_zero back to 0, marking
+        /// its chunk as free if it was full. Writes made by the releasing
+        /// thread are visible to the thread that claims the bit next
+        /// @param pos The bit position
+        void release(size_t pos) noexcept
+        {
+            BITSET_ASSERT(pos < N);
+            release_mask(pos / 64, 1ull << (pos % 64));
+        }
+        /// @brief Sets claimed bits of a chunk back to 0 in one atomic
+        /// operation, marking the chunk as free if it was full
+        /// @param chunk The chunk index
+        /// @param mask The bits to release
+        void release_mask(size_t chunk, uint64_t mask) noexcept
+        {
+            BITSET_ASSERT(chunk < NUM_CHUNKS);
+            const uint64_t old = m_storage[chunk].fetch_and(~mask, std::memory_order_acq_rel);
+            BITSET_ASSERT((old & mask) == mask);
+            if (old == ~0ull)
+                mark_free(0, chunk);
+        }
+    private:
+        /// @brief The internal value
+        Storage_t m_storage;
+        /// @brief One bit per chunk (and per summary word above) that is
+        /// set when it may contain a 0 (or a set bit)
+        Summary_t m_free;
+    };
+}
+
+#endif
@@ -9,9 +9,17 @@
 #include <array>
 #include <bit>
 #include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 #include <numeric>
+#include <span>
 #include <string>
 #include <type_traits>
+#include <utility>
+
+#include "bitset_kernels.hpp"
 
 #ifdef _DEBUG
 #define BITSET_ASSERT(x) assert(x)
@@ -21,7 +29,6 @@
 
 namespace better_bitset
 {
-
     /// @brief A proper bitset that supports scanning
     template<size_t N> requires (N > 0)
         class BitSet
@@ -38,19 +45,276 @@ namespace better_bitset
         /// @brief The storage type. Bits are stored from LSB to MSB
         /// and populate lower order storage positions first
         using Storage_t = std::array<Inner_t, NUM_CHUNKS>;
+        /// @brief Whether to use the runtime selected word array kernels
+        /// instead of scalar loops outside of constant evaluation
+        constexpr static bool USE_KERNELS = NUM_CHUNKS > 4;
+        /// @brief Whether first_func_impl evaluates every chunk without
+        /// branching instead of stopping at the first candidate
+        constexpr static bool UNROLL_FIRST = NUM_CHUNKS > 1 && NUM_CHUNKS <= 8;
 
+        /// @brief Branchless version of first_func_impl for a few chunks.
+        /// Compares every chunk against the value COUNT_FUNC counts through,
+        /// then counts only the first candidate, found with a mask and
+        /// countr_zero
+        template<auto COUNT_FUNC, size_t... CHUNKS>
+        constexpr size_t first_func_unrolled(std::index_sequence<CHUNKS...>) const noexcept
+        {
+            constexpr Inner_t SKIP = COUNT_FUNC(Inner_t(0)) == 64 ? 0 : std::numeric_limits<Inner_t>::max();
+            // the last chunk is always a candidate, as counting through it
+            // reaches at least N
+            const unsigned hits = ((static_cast<unsigned>(m_storage[CHUNKS] != SKIP) << CHUNKS) | ...) |
+                (1u << (NUM_CHUNKS - 1));
+            const size_t chunk = std::countr_zero(hits);
+            return std::min(chunk * 64 + COUNT_FUNC(m_storage[chunk]), N);
+        }
         template<auto COUNT_FUNC>
         constexpr size_t first_func_impl() const noexcept {
-            size_t pos = 0;
-            for (Inner_t chunk : m_storage) {
-                size_t chunk_pos = COUNT_FUNC(chunk);
-                pos += chunk_pos;
-                if (chunk_pos != sizeof(Inner_t) * 8)
-                    return pos;
+            if constexpr (UNROLL_FIRST)
+                return first_func_unrolled<COUNT_FUNC>(std::make_index_sequence<NUM_CHUNKS>());
+            else
+            {
+                size_t chunk = 0;
+                // chunks that COUNT_FUNC counts through entirely are all 0 when
+                // scanning for ones, and all 1 when scanning for zeros
+                constexpr bool SKIP_ONES = COUNT_FUNC(Inner_t(0)) != sizeof(Inner_t) * 8;
+                if constexpr (USE_KERNELS)
+                {
+                    if (!std::is_constant_evaluated())
+                    {
+                        const detail::Kernels& kernels = detail::kernels();
+                        chunk = (SKIP_ONES ? kernels.skip_ones : kernels.skip_zeros)(m_storage.data(), NUM_CHUNKS);
+                    }
+                }
+                size_t pos = chunk * 64;
+                for (; chunk < NUM_CHUNKS; ++chunk) {
+                    size_t chunk_pos = COUNT_FUNC(m_storage[chunk]);
+                    pos += chunk_pos;
+                    if (chunk_pos != sizeof(Inner_t) * 8)
+                        return pos;
+                }
+                return N;
+            }
+        }
+        /// @brief Fetches a chunk with every bit equal to VALUE set to 1.
+        /// Bits past N in the last chunk are always 0
+        /// @param chunk The chunk index
+        template<bool VALUE>
+        constexpr Inner_t chunk_of(size_t chunk) const noexcept
+        {
+            if constexpr (VALUE)
+                return m_storage[chunk];
+            if (chunk == NUM_CHUNKS - 1)
+                return static_cast<Inner_t>(~m_storage[chunk] & LAST_MASK);
+            return static_cast<Inner_t>(~m_storage[chunk]);
+        }
+        /// @brief Scans for the first bit equal to VALUE in [pos, end),
+        /// only touching the chunks overlapping the range
+        /// @param pos The first position to consider
+        /// @param end The end of the range, at most N
+        /// @return The position of the bit, or N if there is none
+        template<bool VALUE>
+        constexpr size_t find_next_impl(size_t pos, size_t end = N) const noexcept
+        {
+            BITSET_ASSERT(end <= N);
+            end = std::min(end, N);
+            if (pos >= end)
+                return N;
+            size_t chunk = pos / 64;
+            const size_t last_chunk = (end - 1) / 64;
+            Inner_t bits = chunk_of<VALUE>(chunk) &
+                static_cast<Inner_t>(std::numeric_limits<Inner_t>::max() << (pos % 64));
+            while (bits == 0)
+            {
+                if (++chunk > last_chunk)
+                    return N;
+                bits = chunk_of<VALUE>(chunk);
+            }
+            const size_t result = chunk * 64 + std::countr_zero(bits);
+            return result < end ? result : N;
+        }
+        /// @brief Finds the first bit equal to VALUE of every bitset in a
+        /// batch, as the trailing zeros of the (inverted) storage
+        template<bool VALUE>
+        static void first_batch_impl(std::span<const BitSet> bitsets, std::span<uint16_t> out) noexcept
+        {
+            static_assert(sizeof(BitSet) == sizeof(Inner_t));
+            BITSET_ASSERT(out.size() >= bitsets.size());
+            // counting the trailing ones stops at the first unused bit, but
+            // counting the trailing zeros of an empty set runs past N
+            detail::kernels().trailing_zeros(bitsets.data(), sizeof(Inner_t), bitsets.size(), !VALUE,
+                static_cast<uint16_t>(N), out.data());
+        }
+        /// @brief Scans for a bit equal to VALUE from the cursor to the end,
+        /// then wraps around to the start, and moves the cursor past it
+        /// @return The position of the bit, or N if there is none
+        template<bool VALUE>
+        constexpr size_t find_from_cursor_impl(size_t& cursor) const noexcept
+        {
+            BITSET_ASSERT(cursor < N);
+            size_t pos = find_next_impl<VALUE>(cursor);
+            if (pos == N)
+                pos = find_next_impl<VALUE>(0, cursor);
+            if (pos != N)
+                cursor = pos + 1 == N ? 0 : pos + 1;
+            return pos;
+        }
+        /// @param pos The first bit of the window
+        /// @return The 64 bits starting at pos, with zeros past N
+        constexpr uint64_t window(size_t pos) const noexcept
+        {
+            const size_t chunk = pos / 64;
+            const size_t shift = pos % 64;
+            if (chunk >= NUM_CHUNKS)
+                return 0;
+            uint64_t result = static_cast<uint64_t>(m_storage[chunk]) >> shift;
+            if (shift != 0 && chunk + 1 < NUM_CHUNKS)
+                result |= static_cast<uint64_t>(m_storage[chunk + 1]) << (64 - shift);
+            return result;
+        }
+        /// @return The number of 1 bits in the chunks [begin, end)
+        constexpr size_t count_chunks(size_t begin, size_t end) const noexcept
+        {
+            if constexpr (USE_KERNELS)
+            {
+                if (!std::is_constant_evaluated())
+                    return detail::kernels().count(m_storage.data() + begin, end - begin);
+            }
+            return std::accumulate(m_storage.begin() + begin, m_storage.begin() + end, size_t(0),
+                [](size_t acc, Inner_t val) { return acc + std::popcount(val); });
+        }
+        /// @brief Finds the k-th (from 0) bit equal to VALUE, skipping whole
+        /// chunks by their popcount
+        /// @return The position of the bit, or N if there are not enough
+        template<bool VALUE>
+        constexpr size_t select_impl(size_t k) const noexcept
+        {
+            for (size_t chunk = 0; chunk < NUM_CHUNKS; ++chunk)
+            {
+                const Inner_t bits = chunk_of<VALUE>(chunk);
+                const size_t ones = std::popcount(bits);
+                if (k < ones)
+                    return chunk * 64 + detail::select_in_word(bits, k);
+                k -= ones;
             }
             return N;
         }
+        /// @brief Finds the first run of k consecutive bits equal to VALUE
+        /// with detail::find_run over the normalized chunks
+        /// @return The position where the run starts, or N if there is none
+        template<bool VALUE>
+        constexpr size_t find_run_impl(size_t k) const noexcept
+        {
+            if (k == 0)
+                return 0;
+            if (k > N)
+                return N;
+            const size_t pos = detail::find_run(NUM_CHUNKS, k,
+                [this](size_t chunk) -> uint64_t { return chunk_of<VALUE>(chunk); });
+            return pos < N ? pos : N;
+        }
+        /// @brief Calls func with the position of every bit equal to VALUE
+        template<bool VALUE, typename Func>
+        constexpr void for_each_impl(Func& func) const
+        {
+            for (size_t chunk = 0; chunk < NUM_CHUNKS; ++chunk)
+            {
+                for (Inner_t bits = chunk_of<VALUE>(chunk); bits != 0; bits &= bits - 1)
+                    func(chunk * 64 + std::countr_zero(bits));
+            }
+        }
+        /// @brief Scans backwards for the last bit equal to VALUE, starting
+        /// at pos
+        /// @param pos The last position to consider, clamped to N - 1
+        /// @return The position of the bit, or N if there is none
+        template<bool VALUE>
+        constexpr size_t find_prev_impl(size_t pos) const noexcept
+        {
+            constexpr size_t CHUNK_BITS = sizeof(Inner_t) * 8;
+            pos = std::min(pos, N - 1);
+            size_t chunk = pos / 64;
+            Inner_t bits = chunk_of<VALUE>(chunk) &
+                static_cast<Inner_t>(std::numeric_limits<Inner_t>::max() >> (CHUNK_BITS - 1 - pos % 64));
+            while (bits == 0)
+            {
+                if (chunk-- == 0)
+                    return N;
+                bits = chunk_of<VALUE>(chunk);
+            }
+            return chunk * 64 + CHUNK_BITS - 1 - std::countl_zero(bits);
+        }
     public:
+        /// @brief Forward iterator over the positions of the bits equal
+        /// to VALUE, walking each chunk with countr_zero and clearing the
+        /// lowest visited bit
+        template<bool VALUE>
+        class BitIterator
+        {
+        public:
+            using value_type = size_t;
+            using difference_type = std::ptrdiff_t;
+
+            constexpr BitIterator() noexcept = default;
+            /// @param bitset The bitset to iterate
+            constexpr explicit BitIterator(const BitSet& bitset) noexcept :
+                m_bitset(&bitset), m_bits(bitset.chunk_of<VALUE>(0))
+            {
+                skip_empty();
+            }
+
+            constexpr size_t operator*() const noexcept
+            {
+                return m_chunk * 64 + std::countr_zero(m_bits);
+            }
+            constexpr BitIterator& operator++() noexcept
+            {
+                m_bits &= m_bits - 1;
+                skip_empty();
+                return *this;
+            }
+            constexpr BitIterator operator++(int) noexcept
+            {
+                BitIterator result = *this;
+                ++*this;
+                return result;
+            }
+            constexpr bool operator==(const BitIterator& other) const noexcept
+            {
+                return m_chunk == other.m_chunk && m_bits == other.m_bits;
+            }
+            constexpr bool operator==(std::default_sentinel_t) const noexcept
+            {
+                return m_chunk == NUM_CHUNKS;
+            }
+        private:
+            /// @brief Advances to the next chunk with a matching bit
+            constexpr void skip_empty() noexcept
+            {
+                while (m_bits == 0 && ++m_chunk < NUM_CHUNKS)
+                    m_bits = m_bitset->chunk_of<VALUE>(m_chunk);
+            }
+
+            const BitSet* m_bitset = nullptr;
+            size_t m_chunk = 0;
+            Inner_t m_bits = 0;
+        };
+        /// @brief Range over the positions of the bits equal to VALUE
+        template<bool VALUE>
+        class BitRange
+        {
+        public:
+            /// @param bitset The bitset to iterate
+            constexpr explicit BitRange(const BitSet& bitset) noexcept :
+                m_bitset(bitset) {}
+
+            constexpr BitIterator<VALUE> begin() const noexcept
+            {
+                return BitIterator<VALUE>(m_bitset);
+            }
+            constexpr std::default_sentinel_t end() const noexcept { return {}; }
+        private:
+            const BitSet& m_bitset;
+        };
+
         constexpr BitSet() noexcept : m_storage() {}
         /// @param storage The storage
         constexpr BitSet(Storage_t storage) noexcept requires(N > 64) :
@@ -70,6 +334,12 @@ namespace better_bitset
         /// @return True if all of the bits are set to 1
         constexpr bool all() const noexcept
         {
+            if constexpr (USE_KERNELS)
+            {
+                if (!std::is_constant_evaluated())
+                    return detail::kernels().skip_ones(m_storage.data(), NUM_CHUNKS - 1) == NUM_CHUNKS - 1 &&
+                        m_storage.back() == LAST_MASK;
+            }
             // make sure they are all maximum value up until the last storage,
             // and that the last storage is the mask of the bit size
             return std::all_of(m_storage.begin(), std::prev(m_storage.end()),
@@ -79,12 +349,22 @@ namespace better_bitset
         /// @return True if any of the bits are set to 1
         constexpr bool any() const noexcept
         {
+            if constexpr (USE_KERNELS)
+            {
+                if (!std::is_constant_evaluated())
+                    return detail::kernels().skip_zeros(m_storage.data(), NUM_CHUNKS) != NUM_CHUNKS;
+            }
             return std::any_of(m_storage.begin(), m_storage.end(),
                 [](Inner_t val) { return val != 0; });
         }
         /// @return True if all of the bits are set to 0
         constexpr bool none() const noexcept
         {
+            if constexpr (USE_KERNELS)
+            {
+                if (!std::is_constant_evaluated())
+                    return detail::kernels().skip_zeros(m_storage.data(), NUM_CHUNKS) == NUM_CHUNKS;
+            }
             // make sure they are all 0
             return std::all_of(m_storage.begin(), m_storage.end(),
                 [](Inner_t val) { return val == 0; });
@@ -92,8 +372,36 @@ namespace better_bitset
         /// @return The number of 1 bits
         constexpr size_t count() const noexcept
         {
-            return std::accumulate(m_storage.begin(), m_storage.end(), 0,
-                [](size_t acc, Inner_t val) { return acc + std::popcount(val); });
+            return count_chunks(0, NUM_CHUNKS);
+        }
+        /// @param pos The end of the counted range, at most N
+        /// @return The number of 1 bits before pos
+        constexpr size_t rank(size_t pos) const noexcept
+        {
+            BITSET_ASSERT(pos <= N);
+            const size_t chunk = pos / 64;
+            size_t result = count_chunks(0, chunk);
+            if (pos % 64 != 0)
+                result += std::popcount(static_cast<Inner_t>(m_storage[chunk] & ~(~0ull << (pos % 64))));
+            return result;
+        }
+        /// @param lo The first position of the range
+        /// @param hi The end of the range, at most N
+        /// @return The number of 1 bits in [lo, hi)
+        constexpr size_t count_range(size_t lo, size_t hi) const noexcept
+        {
+            BITSET_ASSERT(hi <= N);
+            hi = std::min(hi, N);
+            if (lo >= hi)
+                return 0;
+            const size_t first_chunk = lo / 64;
+            const size_t last_chunk = (hi - 1) / 64;
+            const uint64_t head = static_cast<uint64_t>(m_storage[first_chunk]) & (~0ull << (lo % 64));
+            const uint64_t tail_mask = ~0ull >> (63 - (hi - 1) % 64);
+            if (first_chunk == last_chunk)
+                return std::popcount(head & tail_mask);
+            return std::popcount(head) + count_chunks(first_chunk + 1, last_chunk) +
+                std::popcount(static_cast<uint64_t>(m_storage[last_chunk]) & tail_mask);
         }
         /// @return The position of the first one in the bitset
         constexpr size_t first_one() const noexcept
@@ -105,6 +413,275 @@ namespace better_bitset
         {
             return first_func_impl<std::countr_one<Inner_t>>();
         }
+        /// @param pos The position to start scanning from
+        /// @return The position of the first one at or after pos, or N
+        /// if there is none
+        constexpr size_t find_next_one(size_t pos) const noexcept
+        {
+            return find_next_impl<true>(pos);
+        }
+        /// @param pos The position to start scanning from
+        /// @return The position of the first zero at or after pos, or N
+        /// if there is none
+        constexpr size_t find_next_zero(size_t pos) const noexcept
+        {
+            return find_next_impl<false>(pos);
+        }
+        /// @brief Finds the first one of a combination of bitsets, combining
+        /// them chunk by chunk without materializing the result
+        /// @param op Combines one chunk of every bitset, for example
+        /// [](auto a, auto b) { return a & ~b; }
+        /// @param sets The bitsets to combine
+        /// @return The position of the first one of the combination, or N if
+        /// there is none
+        template<typename Op, typename... Sets>
+            requires (std::same_as<Sets, BitSet> && ...)
+        static constexpr size_t first_one_of(Op op, const Sets&... sets)
+        {
+            for (size_t chunk = 0; chunk < NUM_CHUNKS; ++chunk)
+            {
+                Inner_t bits = static_cast<Inner_t>(op(sets.m_storage[chunk]...));
+                // complemented chunks have ones past N
+                if (chunk == NUM_CHUNKS - 1)
+                    bits &= static_cast<Inner_t>(LAST_MASK);
+                if (bits != 0)
+                    return chunk * 64 + std::countr_zero(bits);
+            }
+            return N;
+        }
+        /// @param other The bitset to compare with
+        /// @return The first position where the bitsets differ, or N if they
+        /// are equal
+        constexpr size_t first_difference(const BitSet& other) const noexcept
+        {
+            return find_next_difference(other, 0);
+        }
+        /// @brief Scans for the next position where the bitsets differ, as
+        /// the first one of their exclusive or. Whole equal chunks are
+        /// skipped with SIMD for large sizes
+        /// @param other The bitset to compare with
+        /// @param pos The first position to consider
+        /// @return The position, or N if the bitsets are equal from pos
+        constexpr size_t find_next_difference(const BitSet& other, size_t pos) const noexcept
+        {
+            if (pos >= N)
+                return N;
+            size_t chunk = pos / 64;
+            const Inner_t head = static_cast<Inner_t>(m_storage[chunk] ^ other.m_storage[chunk]) &
+                static_cast<Inner_t>(std::numeric_limits<Inner_t>::max() << (pos % 64));
+            if (head != 0)
+                return chunk * 64 + std::countr_zero(head);
+            ++chunk;
+            if constexpr (USE_KERNELS)
+            {
+                if (!std::is_constant_evaluated())
+                    chunk += detail::kernels().mismatch(m_storage.data() + chunk,
+                        other.m_storage.data() + chunk, NUM_CHUNKS - chunk);
+            }
+            for (; chunk < NUM_CHUNKS; ++chunk)
+            {
+                const Inner_t bits = m_storage[chunk] ^ other.m_storage[chunk];
+                if (bits != 0)
+                    return chunk * 64 + std::countr_zero(bits);
+            }
+            return N;
+        }
+        /// @brief Finds the first occurrence of a bit pattern, testing 64
+        /// starting positions at once: for every bit of the pattern, the
+        /// candidates are ANDed with the window of the set shifted by that
+        /// bit (or its complement)
+        /// @param pattern The bits to find, in the same order as stored
+        /// @param pos The first starting position to consider
+        /// @return The position where the pattern starts, or N if it does
+        /// not occur
+        template<size_t M>
+        constexpr size_t find_pattern(const BitSet<M>& pattern, size_t pos = 0) const noexcept
+        {
+            if constexpr (M > N)
+                return N;
+            else
+            {
+                constexpr size_t LAST_START = N - M;
+                for (size_t base = pos; base <= LAST_START; base += 64)
+                {
+                    // bit i is set while the pattern may still start at base + i
+                    uint64_t candidates = LAST_START - base >= 63 ? ~0ull : ~(~0ull << (LAST_START - base + 1));
+                    for (size_t bit = 0; bit < M && candidates != 0; ++bit)
+                    {
+                        const uint64_t text = window(base + bit);
+                        candidates &= pattern.test(bit) ? text : ~text;
+                    }
+                    if (candidates != 0)
+                        return base + std::countr_zero(candidates);
+                }
+                return N;
+            }
+        }
+        /// @param lo The first position of the range
+        /// @param hi The end of the range, at most N
+        /// @return The position of the first one in [lo, hi), or N if there
+        /// is none
+        constexpr size_t first_one_in(size_t lo, size_t hi) const noexcept
+        {
+            return find_next_impl<true>(lo, hi);
+        }
+        /// @param lo The first position of the range
+        /// @param hi The end of the range, at most N
+        /// @return The position of the first zero in [lo, hi), or N if there
+        /// is none
+        constexpr size_t first_zero_in(size_t lo, size_t hi) const noexcept
+        {
+            return find_next_impl<false>(lo, hi);
+        }
+        /// @brief Finds the next one in a round-robin fashion, scanning from
+        /// the cursor to the end and then from the start to the cursor. On
+        /// success the cursor is moved past the found position
+        /// @param cursor The position to start from, less than N
+        /// @return The position of the one, or N if there is none
+        constexpr size_t find_one_from_cursor(size_t& cursor) const noexcept
+        {
+            return find_from_cursor_impl<true>(cursor);
+        }
+        /// @brief Finds the next zero in a round-robin fashion, scanning from
+        /// the cursor to the end and then from the start to the cursor. On
+        /// success the cursor is moved past the found position, so that
+        /// repeated allocations spread over the whole set instead of reusing
+        /// the lowest positions
+        /// @param cursor The position to start from, less than N
+        /// @return The position of the zero, or N if there is none
+        constexpr size_t find_zero_from_cursor(size_t& cursor) const noexcept
+        {
+            return find_from_cursor_impl<false>(cursor);
+        }
+        /// @return The position of the last one in the bitset, or N if
+        /// there is none
+        constexpr size_t last_one() const noexcept
+        {
+            return find_prev_impl<true>(N - 1);
+        }
+        /// @return The position of the last zero in the bitset, or N if
+        /// there is none
+        constexpr size_t last_zero() const noexcept
+        {
+            return find_prev_impl<false>(N - 1);
+        }
+        /// @param pos The position to start scanning backwards from
+        /// @return The position of the last one at or before pos, or N
+        /// if there is none
+        constexpr size_t find_prev_one(size_t pos) const noexcept
+        {
+            return find_prev_impl<true>(pos);
+        }
+        /// @param pos The position to start scanning backwards from
+        /// @return The position of the last zero at or before pos, or N
+        /// if there is none
+        constexpr size_t find_prev_zero(size_t pos) const noexcept
+        {
+            return find_prev_impl<false>(pos);
+        }
+        /// @param k The number of ones to skip
+        /// @return The position of the k-th (from 0) one in the bitset, or
+        /// N if there are k or fewer ones
+        constexpr size_t select_one(size_t k) const noexcept
+        {
+            return select_impl<true>(k);
+        }
+        /// @param k The number of zeros to skip
+        /// @return The position of the k-th (from 0) zero in the bitset, or
+        /// N if there are k or fewer zeros
+        constexpr size_t select_zero(size_t k) const noexcept
+        {
+            return select_impl<false>(k);
+        }
+        /// @param k The length of the run
+        /// @return The position of the first run of k consecutive ones, or
+        /// N if there is none
+        constexpr size_t find_one_run(size_t k) const noexcept
+        {
+            return find_run_impl<true>(k);
+        }
+        /// @param k The length of the run
+        /// @return The position of the first run of k consecutive zeros, or
+        /// N if there is none
+        constexpr size_t find_zero_run(size_t k) const noexcept
+        {
+            return find_run_impl<false>(k);
+        }
+        /// @return A range over the positions of the ones in the bitset,
+        /// in ascending order
+        constexpr BitRange<true> ones() const& noexcept
+        {
+            return BitRange<true>(*this);
+        }
+        /// @return A range over the positions of the zeros in the bitset,
+        /// in ascending order
+        constexpr BitRange<false> zeros() const& noexcept
+        {
+            return BitRange<false>(*this);
+        }
+        /// @brief The ranges refer to the bitset, so they cannot be taken
+        /// from a temporary that would be gone before the loop runs
+        BitRange<true> ones() const&& = delete;
+        BitRange<false> zeros() const&& = delete;
+        /// @brief Calls func with the position of every one in the bitset,
+        /// in ascending order
+        template<typename Func>
+        constexpr void for_each_one(Func func) const
+        {
+            for_each_impl<true>(func);
+        }
+        /// @brief Calls func with the position of every zero in the bitset,
+        /// in ascending order
+        template<typename Func>
+        constexpr void for_each_zero(Func func) const
+        {
+            for_each_impl<false>(func);
+        }
+        /// @brief Writes the positions of the ones in the bitset in
+        /// ascending order, decoding whole chunks with SIMD when available
+        /// @param out The positions. Decoding stops once it is full, and
+        /// entries past the returned count may be overwritten
+        /// @return The number of positions written
+        constexpr size_t to_indices(std::span<uint32_t> out) const noexcept
+            requires(N - 1 <= std::numeric_limits<uint32_t>::max())
+        {
+            if constexpr (USE_KERNELS)
+            {
+                if (!std::is_constant_evaluated())
+                    return detail::kernels().to_indices(m_storage.data(), NUM_CHUNKS, out.data(), out.size());
+            }
+            size_t written = 0;
+            for (size_t chunk = 0; chunk < NUM_CHUNKS; ++chunk)
+            {
+                for (Inner_t bits = m_storage[chunk]; bits != 0; bits &= bits - 1)
+                {
+                    if (written == out.size())
+                        return written;
+                    out[written++] = static_cast<uint32_t>(chunk * 64 + std::countr_zero(bits));
+                }
+            }
+            return written;
+        }
+        /// @brief Finds the first one of every bitset in a batch, handling
+        /// several bitsets per SIMD register when available
+        /// @param bitsets The bitsets to scan
+        /// @param out The position of the first one of each bitset, or N.
+        /// Must be at least as large as bitsets
+        static void first_one_batch(std::span<const BitSet> bitsets, std::span<uint16_t> out) noexcept
+            requires(N <= 64)
+        {
+            first_batch_impl<true>(bitsets, out);
+        }
+        /// @brief Finds the first zero of every bitset in a batch, handling
+        /// several bitsets per SIMD register when available
+        /// @param bitsets The bitsets to scan
+        /// @param out The position of the first zero of each bitset, or N.
+        /// Must be at least as large as bitsets
+        static void first_zero_batch(std::span<const BitSet> bitsets, std::span<uint16_t> out) noexcept
+            requires(N <= 64)
+        {
+            first_batch_impl<false>(bitsets, out);
+        }
         /// @brief Tests the bit at a an index. Does not perform a bounds
         /// check in release
         /// @param pos The bit position
@@ -113,6 +690,11 @@ namespace better_bitset
         {
             return (*this)[pos];
         }
+        /// @return The underlying storage
+        constexpr const Storage_t& storage() const noexcept
+        {
+            return m_storage;
+        }
 
         /* CAPACITY */
 
@@ -176,6 +758,110 @@ namespace better_bitset
             m_storage[0] &= ~(1ull << pos) & LAST_MASK;
             return *this;
         }
+        /// @brief Sets a range of bits to 1, writing each chunk it covers
+        /// once
+        /// @param pos The first bit of the range
+        /// @param count The number of bits, at most N - pos
+        BitSet& set_range(size_t pos, size_t count) noexcept
+        {
+            BITSET_ASSERT(pos + count <= N);
+            detail::for_each_word_mask(pos, count, [this](size_t chunk, uint64_t mask) {
+                m_storage[chunk] |= static_cast<Inner_t>(mask);
+                return true;
+            });
+            return *this;
+        }
+        /// @brief Sets a range of bits to 0, writing each chunk it covers
+        /// once
+        /// @param pos The first bit of the range
+        /// @param count The number of bits, at most N - pos
+        BitSet& reset_range(size_t pos, size_t count) noexcept
+        {
+            BITSET_ASSERT(pos + count <= N);
+            detail::for_each_word_mask(pos, count, [this](size_t chunk, uint64_t mask) {
+                m_storage[chunk] &= static_cast<Inner_t>(~mask);
+                return true;
+            });
+            return *this;
+        }
+        /// @brief Finds the first zero and sets it to 1 in the same pass
+        /// over the storage
+        /// @return The position of the claimed bit, or N if all bits are set
+        size_t claim_first_zero() noexcept
+        {
+            size_t chunk = 0;
+            if constexpr (USE_KERNELS)
+                chunk = std::min(detail::kernels().skip_ones(m_storage.data(), NUM_CHUNKS), NUM_CHUNKS - 1);
+            else
+            {
+                while (chunk < NUM_CHUNKS - 1 && m_storage[chunk] == std::numeric_limits<Inner_t>::max())
+                    ++chunk;
+            }
+            Inner_t& bits = m_storage[chunk];
+            const size_t pos = chunk * 64 + std::countr_one(bits);
+            if (pos >= N)
+                return N;
+            // sets the lowest 0 bit
+            bits |= bits + 1;
+            return pos;
+        }
+        /// @brief Finds up to k zeros, lowest first, and sets them to 1 in a
+        /// single pass, harvesting each chunk with one store
+        /// @param k The number of bits to claim
+        /// @param out The positions of the claimed bits. Must be at least k
+        /// long
+        /// @return The number of bits claimed, which is less than k if the
+        /// set became full
+        size_t claim_n(size_t k, std::span<size_t> out) noexcept
+        {
+            BITSET_ASSERT(out.size() >= k);
+            size_t claimed = 0;
+            for (size_t chunk = 0; claimed < k && chunk < NUM_CHUNKS; ++chunk)
+            {
+                if constexpr (USE_KERNELS)
+                {
+                    chunk += detail::kernels().skip_ones(m_storage.data() + chunk, NUM_CHUNKS - chunk);
+                    if (chunk == NUM_CHUNKS)
+                        break;
+                }
+                const Inner_t available = chunk_of<false>(chunk);
+                Inner_t rest = available;
+                for (; rest != 0 && claimed < k; rest &= rest - 1)
+                    out[claimed++] = chunk * 64 + std::countr_zero(rest);
+                m_storage[chunk] |= available ^ rest;
+            }
+            return claimed;
+        }
+        /// @brief Sets a bit claimed by claim_first_zero back to 0
+        /// @param pos The bit position
+        BitSet& release(size_t pos) noexcept
+        {
+            BITSET_ASSERT(test(pos));
+            return reset(pos);
+        }
+        /// @brief Finds the first run of k zeros and sets it to 1
+        /// @param k The length of the run, at least 1
+        /// @return The position where the claimed run starts, or N if there
+        /// is none
+        size_t claim_run(size_t k) noexcept
+        {
+            BITSET_ASSERT(k > 0);
+            const size_t pos = find_zero_run(k);
+            if (pos != N)
+                set_range(pos, k);
+            return pos;
+        }
+        /// @brief Sets a run claimed by claim_run back to 0
+        /// @param pos The position where the run starts
+        /// @param k The length of the run
+        BitSet& release_range(size_t pos, size_t k) noexcept
+        {
+            BITSET_ASSERT(pos + k <= N);
+#ifdef _DEBUG
+            BITSET_ASSERT(count_range(pos, pos + k) == k);
+#endif
+            return reset_range(pos, k);
+        }
 
         /* CONVERSIONS */
 
@@ -201,7 +887,7 @@ namespace better_bitset
             {
                 const size_t chunk = pos / 64;
                 const size_t shift = pos % 64;
-                return static_cast<bool>(m_storage[chunk] >> shift);
+                return static_cast<bool>((m_storage[chunk] >> shift) & 0x1);
             }
             return static_cast<bool>((m_storage[0] >> pos) & 0x1);
         }
@@ -223,6 +909,35 @@ namespace better_bitset
         Storage_t m_storage;
     };
 
+    /// @return The position of the first one in the intersection of the
+    /// bitsets, or N if there is none
+    template<size_t N, typename... Sets>
+    constexpr size_t first_one_and(const BitSet<N>& first, const Sets&... rest)
+    {
+        return BitSet<N>::first_one_of([](auto... chunks) { return (chunks & ...); }, first, rest...);
+    }
+    /// @return The position of the first one in the union of the bitsets, or
+    /// N if there is none
+    template<size_t N, typename... Sets>
+    constexpr size_t first_one_or(const BitSet<N>& first, const Sets&... rest)
+    {
+        return BitSet<N>::first_one_of([](auto... chunks) { return (chunks | ...); }, first, rest...);
+    }
+    /// @return The position of the first one in the exclusive or of the
+    /// bitsets, or N if there is none
+    template<size_t N, typename... Sets>
+    constexpr size_t first_one_xor(const BitSet<N>& first, const Sets&... rest)
+    {
+        return BitSet<N>::first_one_of([](auto... chunks) { return (chunks ^ ...); }, first, rest...);
+    }
+    /// @return The position of the first one in a that is zero in b, or N if
+    /// there is none
+    template<size_t N>
+    constexpr size_t first_one_andnot(const BitSet<N>& a, const BitSet<N>& b)
+    {
+        return BitSet<N>::first_one_of([](auto x, auto y) { return x & ~y; }, a, b);
+    }
+
     // constexpr tests
     void test()
     {
@@ -264,6 +979,138 @@ namespace better_bitset
         static_assert(e.count() == 1);
         static_assert(e.first_one() == 128);
         static_assert(e.first_zero() == 0);
+        static_assert(a.find_next_one(1) == 2);
+        static_assert(a.find_next_zero(2) == 3);
+        static_assert(a.find_next_one(6) == 8);
+        static_assert(b.find_next_zero(3) == 8);
+        static_assert(c.find_next_one(64) == 64);
+        static_assert(c.find_next_zero(0) == 65);
+        static_assert(e.find_next_one(1) == 128);
+        static_assert(e.find_next_zero(128) == 129);
+        static_assert(e.find_next_one(129) == 129);
+        static_assert(a.last_one() == 5);
+        static_assert(a.last_zero() == 7);
+        static_assert(a.find_prev_one(4) == 4);
+        static_assert(a.find_prev_zero(0) == 8);
+        static_assert(b.last_zero() == 8);
+        static_assert(c.last_one() == 64);
+        static_assert(c.last_zero() == 65);
+        static_assert(d.last_one() == 70);
+        static_assert(d.last_zero() == 69);
+        static_assert(e.last_one() == 128);
+        static_assert(e.find_prev_one(127) == 129);
+        static_assert(e.find_prev_zero(128) == 127);
+        static_assert(a.select_one(0) == 0);
+        static_assert(a.select_one(3) == 5);
+        static_assert(a.select_one(4) == 8);
+        static_assert(a.select_zero(2) == 6);
+        static_assert(c.select_one(64) == 64);
+        static_assert(c.select_zero(0) == 65);
+        static_assert(d.select_zero(69) == 69);
+        static_assert(e.select_one(0) == 128);
+        static_assert(e.select_zero(127) == 127);
+        static_assert(e.select_zero(128) == 129);
+        static_assert(a.rank(0) == 0);
+        static_assert(a.rank(3) == 2);
+        static_assert(a.rank(8) == 4);
+        static_assert(c.rank(64) == 64);
+        static_assert(c.rank(65) == 65);
+        static_assert(e.rank(128) == 0);
+        static_assert(e.rank(129) == 1);
+        static_assert(a.find_one_run(2) == 4);
+        static_assert(a.find_one_run(3) == 8);
+        static_assert(a.find_zero_run(2) == 6);
+        static_assert(b.find_one_run(8) == 0);
+        static_assert(c.find_one_run(65) == 0);
+        static_assert(d.find_zero_run(70) == 0);
+        static_assert(d.find_zero_run(71) == 70);
+        static_assert(e.find_zero_run(128) == 0);
+        static_assert(e.find_zero_run(129) == 129);
+        static_assert(BitSet<192>{ {0xff00000000000000, ~0ull, 1} }.find_one_run(73) == 56);
+        static_assert(BitSet<192>{ {0xff00000000000000, ~0ull, 1} }.find_one_run(74) == 192);
+        static_assert(a.first_one_in(1, 8) == 2);
+        static_assert(a.first_one_in(6, 8) == 8);
+        static_assert(a.first_zero_in(4, 6) == 8);
+        static_assert(a.first_zero_in(3, 3) == 8);
+        static_assert(e.first_one_in(0, 128) == 129);
+        static_assert(e.first_one_in(64, 129) == 128);
+        static_assert(e.first_zero_in(128, 129) == 129);
+        static_assert(first_one_and(a, BitSet<8>(0b00110100)) == 2);
+        static_assert(first_one_and(a, b, BitSet<8>(0b10000000)) == 8);
+        static_assert(first_one_or(d, d) == 70);
+        static_assert(first_one_or(d, d, BitSet<70>{ {0, 2} }) == 65);
+        static_assert(first_one_xor(a, b) == 1);
+        static_assert(first_one_andnot(b, a) == 1);
+        static_assert(first_one_andnot(BitSet<70>(), d) == 70);
+        static_assert(BitSet<129>::first_one_of([](auto x) { return ~x; }, e) == 0);
+        static_assert(BitSet<129>::first_one_of([](auto x, auto y) { return x & ~y; },
+            e, BitSet<129>{ {~0ull, ~0ull, 0} }) == 128);
+        static_assert([] {
+            constexpr BitSet<8> f(0b00110101);
+            size_t cursor = 6;
+            const size_t first = f.find_zero_from_cursor(cursor);
+            const size_t second = f.find_zero_from_cursor(cursor);
+            const size_t third = f.find_zero_from_cursor(cursor);
+            return first == 6 && second == 7 && third == 1 && cursor == 2;
+        }());
+        static_assert([] {
+            constexpr BitSet<129> f{ {0, 0, 1} };
+            size_t cursor = 100;
+            return f.find_one_from_cursor(cursor) == 128 && cursor == 0 &&
+                f.find_one_from_cursor(cursor) == 128;
+        }());
+        static_assert([] {
+            constexpr BitSet<8> f(0b11111111);
+            size_t cursor = 3;
+            return f.find_zero_from_cursor(cursor) == 8 && cursor == 3;
+        }());
+        static_assert(a.first_difference(a) == 8);
+        static_assert(a.first_difference(b) == 1);
+        static_assert(a.find_next_difference(b, 2) == 3);
+        static_assert(a.find_next_difference(b, 8) == 8);
+        static_assert(e.first_difference(BitSet<129>()) == 128);
+        static_assert(c.find_next_difference(BitSet<65>{ {~0ull, 0} }, 1) == 64);
+        static_assert(a.find_pattern(BitSet<3>(0b101)) == 0);
+        static_assert(a.find_pattern(BitSet<3>(0b101), 1) == 2);
+        static_assert(a.find_pattern(BitSet<2>(0b00)) == 6);
+        static_assert(a.find_pattern(BitSet<3>(0b111)) == 8);
+        static_assert(a.find_pattern(BitSet<9>()) == 8);
+        static_assert(e.find_pattern(BitSet<2>(0b10)) == 127);
+        static_assert(e.find_pattern(BitSet<66>{ {0, 2} }, 1) == 63);
+        static_assert(a.count_range(0, 8) == 4);
+        static_assert(a.count_range(1, 5) == 2);
+        static_assert(a.count_range(3, 3) == 0);
+        static_assert(c.count_range(1, 65) == 64);
+        static_assert(c.count_range(63, 64) == 1);
+        static_assert(e.count_range(0, 128) == 0);
+        static_assert(e.count_range(100, 129) == 1);
+        static_assert(std::forward_iterator<BitSet<8>::BitIterator<true>>);
+        static_assert(*a.ones().begin() == 0);
+        static_assert(*++a.zeros().begin() == 3);
+        static_assert(b.zeros().begin() == std::default_sentinel);
+        static_assert([] {
+            constexpr BitSet<129> f{ {0x8000000000000001, 0, 1} };
+            size_t sum = 0;
+            for (size_t pos : f.ones())
+                sum += pos;
+            return sum;
+        }() == 0 + 63 + 128);
+        static_assert([] {
+            constexpr BitSet<70> g{ {0xfffffffffffffffe, 0x3e} };
+            size_t sum = 0;
+            g.for_each_zero([&](size_t pos) { sum += pos; });
+            return sum;
+        }() == 0 + 64);
+        static_assert([] {
+            constexpr BitSet<8> f(0b00110101);
+            std::array<uint32_t, 8> out{};
+            return f.to_indices(out) == 4 && out[0] == 0 && out[1] == 2 && out[2] == 4 && out[3] == 5;
+        }());
+        static_assert([] {
+            constexpr BitSet<129> f{ {0x8000000000000001, 0, 1} };
+            std::array<uint32_t, 2> out{};
+            return f.to_indices(out) == 2 && out[0] == 0 && out[1] == 63;
+        }());
     }
 }
 
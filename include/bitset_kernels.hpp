@@ -0,0 +1,702 @@
+/// @file bitset_kernels.hpp
+/// @brief Word array kernels used by the bitsets for large sizes, selected
+/// once at runtime for the host CPU
+
+#ifndef BITSET_KERNELS_H_
+#define BITSET_KERNELS_H_
+
+// STL includes
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define BETTER_BITSET_X86 1
+#endif
+
+// GCC and clang need the instruction set enabled per function to compile the
+// kernels into a generic binary, and can query the CPU at runtime. Other
+// compilers select the kernels enabled at compile time instead
+#if defined(BETTER_BITSET_X86) && (defined(__GNUC__) || defined(__clang__))
+#define BETTER_BITSET_DISPATCH 1
+#define BETTER_BITSET_TARGET(isa) __attribute__((target(isa)))
+#else
+#define BETTER_BITSET_TARGET(isa)
+#endif
+
+namespace better_bitset::detail
+{
+    /* WORD */
+
+    /// @brief Finds the position of the k-th (from 0) 1 bit in a word by
+    /// narrowing down the position by halves of the word using popcount
+    /// @param word The word, which must have more than k 1 bits
+    /// @param k The number of 1 bits to skip
+    /// @return The position of the bit
+    constexpr size_t select_in_word_scalar(uint64_t word, size_t k) noexcept
+    {
+        size_t pos = 0;
+        for (size_t width = 32; width > 0; width /= 2)
+        {
+            const size_t ones = std::popcount(word & ((1ull << width) - 1));
+            if (k >= ones)
+            {
+                k -= ones;
+                word >>= width;
+                pos += width;
+            }
+        }
+        return pos;
+    }
+    /// @brief Finds the runs of 1 bits of a given length in a word by
+    /// repeatedly ANDing it with shifted copies of itself
+    /// @param word The word
+    /// @param length The run length, from 1 to 64
+    /// @return A word with bit i set if bits [i, i + length) are all 1
+    constexpr uint64_t run_starts(uint64_t word, size_t length) noexcept
+    {
+        // bit i stays set while bits [i, i + covered) are all 1
+        size_t covered = 1;
+        while (covered < length && word != 0)
+        {
+            const size_t shift = std::min(covered, length - covered);
+            word &= word >> shift;
+            covered += shift;
+        }
+        return word;
+    }
+
+    /// @brief Finds the first run of 1 bits of a given length across an
+    /// array of words. Runs crossing words are tracked by the length of
+    /// the run at the top of the previous word
+    /// @param size The number of words
+    /// @param k The run length, at least 1
+    /// @param word Returns the word at an index
+    /// @return The position where the run starts, or size * 64 if there is
+    /// none
+    template<typename Word_f>
+    constexpr size_t find_run(size_t size, size_t k, Word_f word)
+    {
+        size_t run = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            const uint64_t bits = word(i);
+            if (bits == ~0ull)
+            {
+                if (run + 64 >= k)
+                    return i * 64 - run;
+                run += 64;
+                continue;
+            }
+            if (run + std::countr_one(bits) >= k)
+                return i * 64 - run;
+            if (k <= 64)
+            {
+                const uint64_t starts = run_starts(bits, k);
+                if (starts != 0)
+                    return i * 64 + std::countr_zero(starts);
+            }
+            run = std::countl_one(bits);
+        }
+        return size * 64;
+    }
+    /// @brief Calls func with the index and mask of every 64-bit word that
+    /// a range of bits covers, in ascending order
+    /// @param pos The first bit of the range
+    /// @param count The number of bits
+    /// @param func Called as func(index, mask), stopping early if it returns
+    /// false
+    /// @return False if func stopped early
+    template<typename Func>
+    constexpr bool for_each_word_mask(size_t pos, size_t count, Func func)
+    {
+        while (count > 0)
+        {
+            const size_t shift = pos % 64;
+            const size_t width = std::min<size_t>(count, 64 - shift);
+            if (!func(pos / 64, (~0ull >> (64 - width)) << shift))
+                return false;
+            pos += width;
+            count -= width;
+        }
+        return true;
+    }
+
+    /* SCALAR */
+
+    /// @brief Scans for the first chunk that is not all 0 (or all 1 if
+    /// SKIP_ONES)
+    /// @param chunks The chunks to scan
+    /// @param size The number of chunks
+    /// @return The index of the chunk, or size if there is none
+    template<bool SKIP_ONES>
+    inline size_t skip_chunks_scalar(const uint64_t* chunks, size_t size) noexcept
+    {
+        constexpr uint64_t SKIP = SKIP_ONES ? ~0ull : 0ull;
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (chunks[i] != SKIP)
+                return i;
+        }
+        return size;
+    }
+    /// @param chunks The chunks to count
+    /// @param size The number of chunks
+    /// @return The number of 1 bits in the chunks
+    inline size_t count_scalar(const uint64_t* chunks, size_t size) noexcept
+    {
+        size_t result = 0;
+        for (size_t i = 0; i < size; ++i)
+            result += std::popcount(chunks[i]);
+        return result;
+    }
+    /// @brief Scans two chunk arrays for the first chunk where they differ
+    /// @param a The first chunks
+    /// @param b The second chunks
+    /// @param size The number of chunks in each
+    /// @return The index of the chunk, or size if there is none
+    inline size_t mismatch_scalar(const uint64_t* a, const uint64_t* b, size_t size) noexcept
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (a[i] != b[i])
+                return i;
+        }
+        return size;
+    }
+    /// @brief Writes the positions of the 1 bits of chunks [first, size)
+    /// in ascending order, clearing the lowest bit of each chunk until it
+    /// is empty
+    /// @param chunks The chunks to decode
+    /// @param first The first chunk to decode
+    /// @param size The number of chunks
+    /// @param out The positions
+    /// @param written The number of positions already in out
+    /// @param capacity The size of out. Decoding stops once it is full
+    /// @return The number of positions in out
+    inline size_t to_indices_from(const uint64_t* chunks, size_t first, size_t size, uint32_t* out,
+        size_t written, size_t capacity) noexcept
+    {
+        for (size_t i = first; i < size; ++i)
+        {
+            for (uint64_t word = chunks[i]; word != 0; word &= word - 1)
+            {
+                if (written == capacity)
+                    return written;
+                out[written++] = static_cast<uint32_t>(i * 64 + std::countr_zero(word));
+            }
+        }
+        return written;
+    }
+    /// @brief Writes the positions of the 1 bits in ascending order
+    /// @param chunks The chunks to decode
+    /// @param size The number of chunks
+    /// @param out The positions
+    /// @param capacity The size of out. Decoding stops once it is full
+    /// @return The number of positions written
+    inline size_t to_indices_scalar(const uint64_t* chunks, size_t size, uint32_t* out,
+        size_t capacity) noexcept
+    {
+        return to_indices_from(chunks, 0, size, out, 0, capacity);
+    }
+
+    /// @brief Counts the trailing zeros of each word in an array
+    /// @param words The words
+    /// @param size The number of words
+    /// @param invert Whether to count trailing ones instead
+    /// @param limit The largest count to report
+    /// @param out The counts, one per word
+    template<typename Word_t>
+    inline void trailing_zeros_scalar_impl(const void* words, size_t size, bool invert,
+        uint16_t limit, uint16_t* out) noexcept
+    {
+        const auto* bytes = static_cast<const unsigned char*>(words);
+        const Word_t flip = invert ? static_cast<Word_t>(~Word_t(0)) : Word_t(0);
+        for (size_t i = 0; i < size; ++i)
+        {
+            Word_t word;
+            std::memcpy(&word, bytes + i * sizeof(Word_t), sizeof(Word_t));
+            const size_t count = std::countr_zero(static_cast<Word_t>(word ^ flip));
+            out[i] = static_cast<uint16_t>(std::min<size_t>(count, limit));
+        }
+    }
+    /// @brief Counts the trailing zeros of each word in an array of 1, 2, 4
+    /// or 8 byte words
+    /// @param words The words
+    /// @param word_bytes The size of each word
+    /// @param size The number of words
+    /// @param invert Whether to count trailing ones instead
+    /// @param limit The largest count to report
+    /// @param out The counts, one per word
+    inline void trailing_zeros_scalar(const void* words, size_t word_bytes, size_t size, bool invert,
+        uint16_t limit, uint16_t* out) noexcept
+    {
+        switch (word_bytes)
+        {
+        case 1: return trailing_zeros_scalar_impl<uint8_t>(words, size, invert, limit, out);
+        case 2: return trailing_zeros_scalar_impl<uint16_t>(words, size, invert, limit, out);
+        case 4: return trailing_zeros_scalar_impl<uint32_t>(words, size, invert, limit, out);
+        default: return trailing_zeros_scalar_impl<uint64_t>(words, size, invert, limit, out);
+        }
+    }
+
+#if defined(BETTER_BITSET_X86)
+    /* BMI2 */
+
+    /// @brief BMI2 version of select_in_word_scalar, depositing a single
+    /// bit at the k-th 1 bit of the word with PDEP
+    BETTER_BITSET_TARGET("bmi2")
+    inline size_t select_in_word_bmi2(uint64_t word, size_t k) noexcept
+    {
+        return std::countr_zero(_pdep_u64(1ull << k, word));
+    }
+
+    /* AVX2 */
+
+    /// @brief AVX2 version of skip_chunks_scalar, comparing 256 bits at a
+    /// time
+    template<bool SKIP_ONES>
+    BETTER_BITSET_TARGET("avx2")
+    inline size_t skip_chunks_avx2(const uint64_t* chunks, size_t size) noexcept
+    {
+        const __m256i skip = SKIP_ONES ? _mm256_set1_epi64x(-1) : _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(chunks + i));
+            const unsigned skipped = static_cast<unsigned>(
+                _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(block, skip))));
+            if (skipped != 0xf)
+                return i + std::countr_one(skipped);
+        }
+        return i + skip_chunks_scalar<SKIP_ONES>(chunks + i, size - i);
+    }
+    /// @brief AVX2 version of mismatch_scalar, comparing 256 bits at a time
+    BETTER_BITSET_TARGET("avx2")
+    inline size_t mismatch_avx2(const uint64_t* a, const uint64_t* b, size_t size) noexcept
+    {
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4)
+        {
+            const __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            const __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            const unsigned equal = static_cast<unsigned>(
+                _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(left, right))));
+            if (equal != 0xf)
+                return i + std::countr_one(equal);
+        }
+        return i + mismatch_scalar(a + i, b + i, size - i);
+    }
+    /// @brief AVX2 version of count_scalar, using a nibble lookup table
+    BETTER_BITSET_TARGET("avx2")
+    inline size_t count_avx2(const uint64_t* chunks, size_t size) noexcept
+    {
+        const __m256i lookup = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i nibble = _mm256_set1_epi8(0x0f);
+        __m256i total = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(chunks + i));
+            const __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(block, nibble));
+            const __m256i high = _mm256_shuffle_epi8(lookup,
+                _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble));
+            total = _mm256_add_epi64(total,
+                _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+        }
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] + count_scalar(chunks + i, size - i);
+    }
+    /// @brief AVX2 version of trailing_zeros_scalar_impl. Counts the
+    /// trailing zeros of every lane at once as the popcount of the mask
+    /// below the lowest 1 bit, ~x & (x - 1), using a nibble lookup table
+    /// and widening the byte counts to the lane size
+    template<typename Word_t>
+    BETTER_BITSET_TARGET("avx2")
+    inline void trailing_zeros_avx2_impl(const void* words, size_t size, bool invert,
+        uint16_t limit, uint16_t* out) noexcept
+    {
+        constexpr size_t LANES = 32 / sizeof(Word_t);
+        const auto* bytes = static_cast<const unsigned char*>(words);
+        const __m256i flip = invert ? _mm256_set1_epi8(-1) : _mm256_setzero_si256();
+        const __m256i lookup = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i nibble = _mm256_set1_epi8(0x0f);
+        const __m256i limits = _mm256_set1_epi16(static_cast<short>(limit));
+        size_t i = 0;
+        for (; i + LANES <= size; i += LANES)
+        {
+            const __m256i block = _mm256_xor_si256(flip,
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i * sizeof(Word_t))));
+            __m256i decremented;
+            if constexpr (sizeof(Word_t) == 1)
+                decremented = _mm256_sub_epi8(block, _mm256_set1_epi8(1));
+            else if constexpr (sizeof(Word_t) == 2)
+                decremented = _mm256_sub_epi16(block, _mm256_set1_epi16(1));
+            else if constexpr (sizeof(Word_t) == 4)
+                decremented = _mm256_sub_epi32(block, _mm256_set1_epi32(1));
+            else
+                decremented = _mm256_sub_epi64(block, _mm256_set1_epi64x(1));
+            const __m256i below = _mm256_andnot_si256(block, decremented);
+            const __m256i counts = _mm256_add_epi8(
+                _mm256_shuffle_epi8(lookup, _mm256_and_si256(below, nibble)),
+                _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(below, 4), nibble)));
+            if constexpr (sizeof(Word_t) == 1)
+            {
+                const __m256i low = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(counts));
+                const __m256i high = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(counts, 1));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_min_epu16(low, limits));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 16), _mm256_min_epu16(high, limits));
+            }
+            else if constexpr (sizeof(Word_t) == 2)
+            {
+                const __m256i sums = _mm256_maddubs_epi16(counts, _mm256_set1_epi8(1));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_min_epu16(sums, limits));
+            }
+            else if constexpr (sizeof(Word_t) == 4)
+            {
+                const __m256i sums = _mm256_madd_epi16(
+                    _mm256_maddubs_epi16(counts, _mm256_set1_epi8(1)), _mm256_set1_epi16(1));
+                const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(sums, sums), 0b1000);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                    _mm_min_epu16(_mm256_castsi256_si128(packed), _mm256_castsi256_si128(limits)));
+            }
+            else
+            {
+                const __m256i sums = _mm256_sad_epu8(counts, _mm256_setzero_si256());
+                const __m128i low = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(sums,
+                    _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i),
+                    _mm_min_epu16(_mm_packus_epi32(low, low), _mm256_castsi256_si128(limits)));
+            }
+        }
+        trailing_zeros_scalar_impl<Word_t>(bytes + i * sizeof(Word_t), size - i, invert, limit, out + i);
+    }
+    /// @brief AVX2 version of trailing_zeros_scalar
+    BETTER_BITSET_TARGET("avx2")
+    inline void trailing_zeros_avx2(const void* words, size_t word_bytes, size_t size, bool invert,
+        uint16_t limit, uint16_t* out) noexcept
+    {
+        switch (word_bytes)
+        {
+        case 1: return trailing_zeros_avx2_impl<uint8_t>(words, size, invert, limit, out);
+        case 2: return trailing_zeros_avx2_impl<uint16_t>(words, size, invert, limit, out);
+        case 4: return trailing_zeros_avx2_impl<uint32_t>(words, size, invert, limit, out);
+        default: return trailing_zeros_avx2_impl<uint64_t>(words, size, invert, limit, out);
+        }
+    }
+
+    /// @brief Words with fewer 1 bits than this are decoded one bit at a
+    /// time by the SIMD kernels, as expanding every part of the word
+    /// costs more than the few countr_zero it replaces
+    inline constexpr size_t SPARSE_WORD = 8;
+    /// @brief The positions of the 1 bits of every byte value, padded
+    /// with zeros to 8 entries
+    inline constexpr auto BYTE_INDICES = []
+    {
+        std::array<std::array<uint8_t, 8>, 256> table{};
+        for (size_t byte = 0; byte < 256; ++byte)
+        {
+            size_t count = 0;
+            for (uint8_t bit = 0; bit < 8; ++bit)
+            {
+                if (byte & (1u << bit))
+                    table[byte][count++] = bit;
+            }
+        }
+        return table;
+    }();
+    /// @brief AVX2 version of to_indices_scalar. Expands the positions of
+    /// each byte from a lookup table into eight lanes, stores all of them
+    /// and advances by the popcount of the byte. As this writes up to 7
+    /// entries past the last position, chunks are only decoded this way
+    /// while at least 64 entries are left in out
+    BETTER_BITSET_TARGET("avx2")
+    inline size_t to_indices_avx2(const uint64_t* chunks, size_t size, uint32_t* out,
+        size_t capacity) noexcept
+    {
+        size_t written = 0;
+        size_t i = 0;
+        for (; i < size && capacity - written >= 64; ++i)
+        {
+            uint64_t word = chunks[i];
+            if (static_cast<size_t>(std::popcount(word)) < SPARSE_WORD)
+            {
+                for (; word != 0; word &= word - 1)
+                    out[written++] = static_cast<uint32_t>(i * 64 + std::countr_zero(word));
+                continue;
+            }
+            for (size_t base = i * 64; base < (i + 1) * 64; base += 8, word >>= 8)
+            {
+                const uint8_t byte = static_cast<uint8_t>(word);
+                const __m256i positions = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(base)),
+                    _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(BYTE_INDICES[byte].data()))));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + written), positions);
+                written += std::popcount(byte);
+            }
+        }
+        return to_indices_from(chunks, i, size, out, written, capacity);
+    }
+
+    /* AVX-512 */
+
+    /// @brief AVX-512 version of skip_chunks_scalar, testing 512 bits at a
+    /// time with a masked load for the tail
+    template<bool SKIP_ONES>
+    BETTER_BITSET_TARGET("avx512f")
+    inline size_t skip_chunks_avx512(const uint64_t* chunks, size_t size) noexcept
+    {
+        const __m512i ones = _mm512_set1_epi64(-1);
+        for (size_t i = 0; i < size; i += 8)
+        {
+            const __mmask8 valid = size - i >= 8 ? 0xff : static_cast<__mmask8>((1u << (size - i)) - 1);
+            const __m512i block = _mm512_maskz_loadu_epi64(valid, chunks + i);
+            const __mmask8 hits = SKIP_ONES ?
+                _mm512_mask_cmpneq_epi64_mask(valid, block, ones) :
+                _mm512_mask_test_epi64_mask(valid, block, block);
+            if (hits != 0)
+                return i + std::countr_zero(static_cast<unsigned>(hits));
+        }
+        return size;
+    }
+    /// @brief AVX-512 version of mismatch_scalar, comparing 512 bits at a
+    /// time with masked loads for the tail
+    BETTER_BITSET_TARGET("avx512f")
+    inline size_t mismatch_avx512(const uint64_t* a, const uint64_t* b, size_t size) noexcept
+    {
+        for (size_t i = 0; i < size; i += 8)
+        {
+            const __mmask8 valid = size - i >= 8 ? 0xff : static_cast<__mmask8>((1u << (size - i)) - 1);
+            const __mmask8 differ = _mm512_mask_cmpneq_epi64_mask(valid,
+                _mm512_maskz_loadu_epi64(valid, a + i), _mm512_maskz_loadu_epi64(valid, b + i));
+            if (differ != 0)
+                return i + std::countr_zero(static_cast<unsigned>(differ));
+        }
+        return size;
+    }
+    /// @brief AVX-512 version of count_scalar, using VPOPCNTDQ
+    BETTER_BITSET_TARGET("avx512f,avx512vpopcntdq")
+    inline size_t count_avx512_vpopcntdq(const uint64_t* chunks, size_t size) noexcept
+    {
+        __m512i total = _mm512_setzero_si512();
+        for (size_t i = 0; i < size; i += 8)
+        {
+            const __mmask8 valid = size - i >= 8 ? 0xff : static_cast<__mmask8>((1u << (size - i)) - 1);
+            const __m512i block = _mm512_maskz_loadu_epi64(valid, chunks + i);
+            total = _mm512_add_epi64(total, _mm512_popcnt_epi64(block));
+        }
+        alignas(64) uint64_t lanes[8];
+        _mm512_store_si512(lanes, total);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+    }
+    /// @brief AVX-512 version of count_scalar for CPUs without VPOPCNTDQ,
+    /// using a nibble lookup table
+    BETTER_BITSET_TARGET("avx512f,avx512bw")
+    inline size_t count_avx512bw(const uint64_t* chunks, size_t size) noexcept
+    {
+        const __m512i lookup = _mm512_set4_epi32(
+            0x04030302, 0x03020201, 0x03020201, 0x02010100);
+        const __m512i nibble = _mm512_set1_epi8(0x0f);
+        __m512i total = _mm512_setzero_si512();
+        for (size_t i = 0; i < size; i += 8)
+        {
+            const __mmask8 valid = size - i >= 8 ? 0xff : static_cast<__mmask8>((1u << (size - i)) - 1);
+            const __m512i block = _mm512_maskz_loadu_epi64(valid, chunks + i);
+            const __m512i low = _mm512_shuffle_epi8(lookup, _mm512_and_si512(block, nibble));
+            const __m512i high = _mm512_shuffle_epi8(lookup,
+                _mm512_and_si512(_mm512_srli_epi16(block, 4), nibble));
+            total = _mm512_add_epi64(total,
+                _mm512_sad_epu8(_mm512_add_epi8(low, high), _mm512_setzero_si512()));
+        }
+        alignas(64) uint64_t lanes[8];
+        _mm512_store_si512(lanes, total);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+    }
+    /// @brief AVX-512 version of to_indices_scalar. Compresses the positions
+    /// of 16 bits at a time into out with VPCOMPRESSD, which only writes
+    /// the selected lanes
+    BETTER_BITSET_TARGET("avx512f")
+    inline size_t to_indices_avx512(const uint64_t* chunks, size_t size, uint32_t* out,
+        size_t capacity) noexcept
+    {
+        const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        size_t written = 0;
+        size_t i = 0;
+        for (; i < size; ++i)
+        {
+            uint64_t word = chunks[i];
+            const size_t ones = std::popcount(word);
+            if (capacity - written < ones)
+                break;
+            if (ones < SPARSE_WORD)
+            {
+                for (; word != 0; word &= word - 1)
+                    out[written++] = static_cast<uint32_t>(i * 64 + std::countr_zero(word));
+                continue;
+            }
+            for (size_t base = i * 64; base < (i + 1) * 64; base += 16, word >>= 16)
+            {
+                const __mmask16 bits = static_cast<__mmask16>(word);
+                const __m512i positions = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(base)), lanes);
+                _mm512_mask_compressstoreu_epi32(out + written, bits, positions);
+                written += std::popcount(static_cast<uint16_t>(bits));
+            }
+        }
+        return to_indices_from(chunks, i, size, out, written, capacity);
+    }
+#endif
+
+    /* DISPATCH */
+
+    /// @brief The kernels selected for the host CPU
+    struct Kernels
+    {
+        /// @brief Finds the position of the k-th 1 bit in a word
+        size_t (*select_in_word)(uint64_t, size_t) noexcept;
+        /// @brief Finds the first chunk that is not all 0
+        size_t (*skip_zeros)(const uint64_t*, size_t) noexcept;
+        /// @brief Finds the first chunk that is not all 1
+        size_t (*skip_ones)(const uint64_t*, size_t) noexcept;
+        /// @brief Finds the first chunk where two arrays differ
+        size_t (*mismatch)(const uint64_t*, const uint64_t*, size_t) noexcept;
+        /// @brief Counts the 1 bits
+        size_t (*count)(const uint64_t*, size_t) noexcept;
+        /// @brief Counts the trailing zeros of each word in an array
+        void (*trailing_zeros)(const void*, size_t, size_t, bool, uint16_t, uint16_t*) noexcept;
+        /// @brief Writes the positions of the 1 bits. May overwrite entries
+        /// past the returned count
+        size_t (*to_indices)(const uint64_t*, size_t, uint32_t*, size_t) noexcept;
+    };
+
+    /// @return The best kernels supported by the host CPU
+    inline Kernels select_kernels() noexcept
+    {
+        Kernels kernels{
+            &select_in_word_scalar,
+            &skip_chunks_scalar<false>,
+            &skip_chunks_scalar<true>,
+            &mismatch_scalar,
+            &count_scalar,
+            &trailing_zeros_scalar,
+            &to_indices_scalar
+        };
+#if defined(BETTER_BITSET_DISPATCH)
+        __builtin_cpu_init();
+        // PDEP is microcoded and slower than the scalar version before Zen 3
+        const bool bmi2 = __builtin_cpu_supports("bmi2") &&
+            !__builtin_cpu_is("znver1") && !__builtin_cpu_is("znver2");
+        const bool avx2 = __builtin_cpu_supports("avx2");
+        const bool avx512f = __builtin_cpu_supports("avx512f");
+        const bool avx512bw = avx512f && __builtin_cpu_supports("avx512bw");
+        const bool avx512vpopcntdq = avx512f && __builtin_cpu_supports("avx512vpopcntdq");
+#elif defined(BETTER_BITSET_X86)
+#if defined(__BMI2__)
+        constexpr bool bmi2 = true;
+#else
+        constexpr bool bmi2 = false;
+#endif
+#if defined(__AVX2__)
+        constexpr bool avx2 = true;
+#else
+        constexpr bool avx2 = false;
+#endif
+#if defined(__AVX512F__)
+        constexpr bool avx512f = true;
+#else
+        constexpr bool avx512f = false;
+#endif
+#if defined(__AVX512BW__)
+        constexpr bool avx512bw = true;
+#else
+        constexpr bool avx512bw = false;
+#endif
+#if defined(__AVX512VPOPCNTDQ__)
+        constexpr bool avx512vpopcntdq = true;
+#else
+        constexpr bool avx512vpopcntdq = false;
+#endif
+#endif
+#if defined(BETTER_BITSET_X86)
+        if (bmi2)
+            kernels.select_in_word = &select_in_word_bmi2;
+        if (avx2)
+        {
+            kernels.skip_zeros = &skip_chunks_avx2<false>;
+            kernels.skip_ones = &skip_chunks_avx2<true>;
+            kernels.mismatch = &mismatch_avx2;
+            kernels.count = &count_avx2;
+            kernels.trailing_zeros = &trailing_zeros_avx2;
+            kernels.to_indices = &to_indices_avx2;
+        }
+        if (avx512f)
+        {
+            kernels.skip_zeros = &skip_chunks_avx512<false>;
+            kernels.skip_ones = &skip_chunks_avx512<true>;
+            kernels.mismatch = &mismatch_avx512;
+            kernels.to_indices = &to_indices_avx512;
+        }
+        if (avx512vpopcntdq)
+            kernels.count = &count_avx512_vpopcntdq;
+        else if (avx512bw)
+            kernels.count = &count_avx512bw;
+#endif
+        return kernels;
+    }
+
+    /// @return The kernels selected for the host CPU, resolved on first use
+    inline const Kernels& kernels() noexcept
+    {
+        static const Kernels selected = select_kernels();
+        return selected;
+    }
+
+    /* WORD (DISPATCHED) */
+
+    /// @brief Finds the position of the k-th (from 0) 1 bit in a word. Uses
+    /// PDEP directly when compiled with BMI2, through the selected kernels
+    /// when the host CPU supports it, and select_in_word_scalar otherwise
+    /// and in constant evaluation
+    /// @param word The word, which must have more than k 1 bits
+    /// @param k The number of 1 bits to skip
+    /// @return The position of the bit
+    constexpr size_t select_in_word(uint64_t word, size_t k) noexcept
+    {
+        if (!std::is_constant_evaluated())
+        {
+#if defined(__BMI2__)
+            return std::countr_zero(_pdep_u64(1ull << k, word));
+#elif defined(BETTER_BITSET_DISPATCH)
+            return kernels().select_in_word(word, k);
+#endif
+        }
+        return select_in_word_scalar(word, k);
+    }
+    /// @param word The word
+    /// @param count The number of 1 bits to keep
+    /// @return The lowest count 1 bits of the word
+    constexpr uint64_t lowest_ones(uint64_t word, size_t count) noexcept
+    {
+        // clearing the lowest bit a few times beats a select
+        if (count <= 8)
+        {
+            uint64_t rest = word;
+            for (size_t i = 0; i < count && rest != 0; ++i)
+                rest &= rest - 1;
+            return word & ~rest;
+        }
+        if (static_cast<size_t>(std::popcount(word)) <= count)
+            return word;
+        return word & ~(~0ull << select_in_word(word, count));
+    }
+}
+
+#endif
@@ -0,0 +1,280 @@
+/// @file hierarchical_bitset.hpp
+/// @brief A bitset with summary levels for scanning large sizes
+
+#ifndef HIERARCHICAL_BITSET_H_
+#define HIERARCHICAL_BITSET_H_
+
+#include "better_bitset.hpp"
+
+namespace better_bitset
+{
+    namespace detail
+    {
+        /// @brief Layout of 64-ary summary levels over NUM_WORDS words.
+        /// Level 0 has one bit per word, every following level has one bit
+        /// per word of the level below, and the last level is a single word
+        template<size_t NUM_WORDS>
+        struct SummaryLevels
+        {
+            /// @brief The number of summary levels
+            constexpr static size_t NUM_LEVELS = []
+            {
+                size_t levels = 1;
+                for (size_t words = (NUM_WORDS + 63) / 64; words > 1; words = (words + 63) / 64)
+                    ++levels;
+                return levels;
+            }();
+            /// @brief The offset of each level in the summary storage. The
+            /// last entry is the total number of summary words
+            constexpr static std::array<size_t, NUM_LEVELS + 1> OFFSETS = []
+            {
+                std::array<size_t, NUM_LEVELS + 1> offsets{};
+                size_t words = NUM_WORDS;
+                for (size_t level = 0; level < NUM_LEVELS; ++level)
+                {
+                    words = (words + 63) / 64;
+                    offsets[level + 1] = offsets[level] + words;
+                }
+                return offsets;
+            }();
+            /// @brief The total number of summary words
+            constexpr static size_t SIZE = OFFSETS[NUM_LEVELS];
+        };
+    }
+
+    /// @brief A bitset that keeps 64-ary summaries of which chunks contain
+    /// ones and zeros, so that first_one and first_zero cost one
+    /// countr_zero per level regardless of N
+    template<size_t N> requires (N > 0)
+        class HierarchicalBitSet
+    {
+    private:
+        /// @brief The mask of the last bit
+        constexpr static size_t LAST_MASK = ~(~1ull << ((N - 1ull) % (64ull)));
+        /// @brief The number of chunks stored
+        constexpr static size_t NUM_CHUNKS = (N + 63) / 64;
+        /// @brief The summary level layout
+        using Levels = detail::SummaryLevels<NUM_CHUNKS>;
+        /// @brief The storage type. Bits are stored from LSB to MSB
+        /// and populate lower order storage positions first
+        using Storage_t = std::array<uint64_t, NUM_CHUNKS>;
+        /// @brief The summary storage type
+        using Summary_t = std::array<uint64_t, Levels::SIZE>;
+
+        /// @brief Fetches a chunk with every bit equal to VALUE set to 1.
+        /// Bits past N in the last chunk are always 0
+        /// @param chunk The chunk index
+        template<bool VALUE>
+        constexpr uint64_t chunk_of(size_t chunk) const noexcept
+        {
+            if constexpr (VALUE)
+                return m_storage[chunk];
+            if (chunk == NUM_CHUNKS - 1)
+                return ~m_storage[chunk] & LAST_MASK;
+            return ~m_storage[chunk];
+        }
+        /// @brief Propagates a change of a chunk up the VALUE summary,
+        /// stopping at the first level that does not change
+        /// @param chunk The chunk index
+        template<bool VALUE>
+        constexpr void update(size_t chunk) noexcept
+        {
+            Summary_t& summary = VALUE ? m_ones : m_zeros;
+            bool nonempty = chunk_of<VALUE>(chunk) != 0;
+            size_t index = chunk;
+            for (size_t level = 0; level < Levels::NUM_LEVELS; ++level)
+            {
+                uint64_t& word = summary[Levels::OFFSETS[level] + index / 64];
+                const uint64_t bit = 1ull << (index % 64);
+                const uint64_t updated = nonempty ? word | bit : word & ~bit;
+                if (updated == word)
+                    return;
+                word = updated;
+                nonempty = updated != 0;
+                index /= 64;
+            }
+        }
+        /// @brief Recomputes both summaries from the storage
+        constexpr void rebuild() noexcept
+        {
+            m_ones.fill(0);
+            m_zeros.fill(0);
+            for (size_t chunk = 0; chunk < NUM_CHUNKS; ++chunk)
+            {
+                update<true>(chunk);
+                update<false>(chunk);
+            }
+        }
+        /// @brief Descends the VALUE summary to the first bit equal to VALUE
+        /// @return The position of the bit, or N if there is none
+        template<bool VALUE>
+        constexpr size_t first_impl() const noexcept
+        {
+            const Summary_t& summary = VALUE ? m_ones : m_zeros;
+            size_t index = 0;
+            for (size_t level = Levels::NUM_LEVELS; level-- > 0;)
+            {
+                const uint64_t word = summary[Levels::OFFSETS[level] + index];
+                if (word == 0)
+                    return N;
+                index = index * 64 + std::countr_zero(word);
+            }
+            return index * 64 + std::countr_zero(chunk_of<VALUE>(index));
+        }
+    public:
+        constexpr HierarchicalBitSet() noexcept :
+            m_storage(), m_ones(), m_zeros()
+        {
+            rebuild();
+        }
+        /// @param bitset The bitset to copy
+        constexpr explicit HierarchicalBitSet(const BitSet<N>& bitset) noexcept :
+            m_storage(), m_ones(), m_zeros()
+        {
+            bitset.for_each_one([this](size_t pos) {
+                m_storage[pos / 64] |= 1ull << (pos % 64);
+            });
+            rebuild();
+        }
+
+        /* ACCESSORS */
+
+        /// @return True if all of the bits are set to 1
+        constexpr bool all() const noexcept
+        {
+            return m_zeros[Levels::SIZE - 1] == 0;
+        }
+        /// @return True if any of the bits are set to 1
+        constexpr bool any() const noexcept
+        {
+            return m_ones[Levels::SIZE - 1] != 0;
+        }
+        /// @return True if all of the bits are set to 0
+        constexpr bool none() const noexcept
+        {
+            return m_ones[Levels::SIZE - 1] == 0;
+        }
+        /// @return The number of 1 bits
+        constexpr size_t count() const noexcept
+        {
+            if constexpr (NUM_CHUNKS > 4)
+            {
+                if (!std::is_constant_evaluated())
+                    return detail::kernels().count(m_storage.data(), NUM_CHUNKS);
+            }
+            return std::accumulate(m_storage.begin(), m_storage.end(), size_t(0),
+                [](size_t acc, uint64_t val) { return acc + std::popcount(val); });
+        }
+        /// @return The position of the first one in the bitset
+        constexpr size_t first_one() const noexcept
+        {
+            return first_impl<true>();
+        }
+        /// @return The position of the first zero in the bitset
+        constexpr size_t first_zero() const noexcept
+        {
+            return first_impl<false>();
+        }
+        /// @brief Tests the bit at a an index. Does not perform a bounds
+        /// check in release
+        /// @param pos The bit position
+        /// @return The bit's value
+        constexpr bool test(size_t pos) const noexcept
+        {
+            return (*this)[pos];
+        }
+
+        /* CAPACITY */
+
+        constexpr size_t size() const noexcept { return N; }
+
+        /* MODIFIERS */
+
+        /// @brief Sets all bits to true
+        HierarchicalBitSet& set() noexcept
+        {
+            for (size_t i = 0; i < NUM_CHUNKS - 1; ++i)
+                m_storage[i] = std::numeric_limits<uint64_t>::max();
+            m_storage[NUM_CHUNKS - 1] = LAST_MASK;
+            rebuild();
+            return *this;
+        }
+        /// @brief Sets the bit as pos to value
+        HierarchicalBitSet& set(size_t pos, bool value = true) noexcept
+        {
+            BITSET_ASSERT(pos < N);
+            if (value == false)
+                return reset(pos);
+            const size_t chunk = pos / 64;
+            m_storage[chunk] |= 1ull << (pos % 64);
+            update<true>(chunk);
+            update<false>(chunk);
+            return *this;
+        }
+        /// @brief Flips all bits
+        HierarchicalBitSet& flip() noexcept
+        {
+            for (size_t i = 0; i < NUM_CHUNKS - 1; ++i)
+                m_storage[i] = ~m_storage[i];
+            m_storage[NUM_CHUNKS - 1] = ~m_storage[NUM_CHUNKS - 1] & LAST_MASK;
+            std::swap(m_ones, m_zeros);
+            return *this;
+        }
+        /// @brief Sets all bits to false
+        HierarchicalBitSet& reset() noexcept
+        {
+            m_storage.fill(0);
+            rebuild();
+            return *this;
+        }
+        /// @brief Sets the bit at pos to 0
+        HierarchicalBitSet& reset(size_t pos) noexcept
+        {
+            BITSET_ASSERT(pos < N);
+            const size_t chunk = pos / 64;
+            m_storage[chunk] &= ~(1ull << (pos % 64));
+            update<true>(chunk);
+            update<false>(chunk);
+            return *this;
+        }
+
+        /* CONVERSIONS */
+
+        /// @return The bitset as a string
+        std::string to_string() const noexcept
+        {
+            std::string result;
+            for (size_t i = N; i > 0; --i)
+                result += (test(i - 1) ? '1' : '0');
+            return result;
+        }
+
+        /* OPERATORS*/
+
+        /// @brief Fetches the bit at a an index. Does not perform a bounds
+        /// check in release
+        /// @param pos The bit position
+        /// @return The bit's value
+        constexpr bool operator[](size_t pos) const
+        {
+            BITSET_ASSERT(pos < N);
+            return static_cast<bool>((m_storage[pos / 64] >> (pos % 64)) & 0x1);
+        }
+
+        constexpr bool operator==(const HierarchicalBitSet<N>& other) const noexcept
+        {
+            return m_storage == other.m_storage;
+        }
+    private:
+        /// @brief The internal value
+        Storage_t m_storage;
+        /// @brief One bit per chunk (and per summary word above) that is
+        /// set when it contains a 1
+        Summary_t m_ones;
+        /// @brief One bit per chunk (and per summary word above) that is
+        /// set when it contains a 0
+        Summary_t m_zeros;
+    };
+}
+
+#endif
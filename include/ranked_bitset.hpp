@@ -0,0 +1,137 @@
+/// @file ranked_bitset.hpp
+/// @brief A bitset with a precomputed rank directory
+
+#ifndef RANKED_BITSET_H_
+#define RANKED_BITSET_H_
+
+#include "better_bitset.hpp"
+
+namespace better_bitset
+{
+    /// @brief A bitset that stores the number of ones before every 512-bit
+    /// block, so that rank costs at most eight popcounts regardless of N.
+    /// Meant for read-mostly sets, as modifying a bit updates the counts of
+    /// every following block
+    template<size_t N> requires (N > 0)
+        class RankedBitSet
+    {
+    private:
+        /// @brief The number of chunks per block
+        constexpr static size_t BLOCK_CHUNKS = 8;
+        /// @brief The number of bits per block
+        constexpr static size_t BLOCK_BITS = BLOCK_CHUNKS * 64;
+        /// @brief The number of blocks stored
+        constexpr static size_t NUM_BLOCKS = (N + BLOCK_BITS - 1) / BLOCK_BITS;
+        /// @brief The stored count type
+        using Rank_t = std::conditional_t<(N > std::numeric_limits<uint32_t>::max()), uint64_t, uint32_t>;
+        /// @brief The directory type
+        using Directory_t = std::array<Rank_t, NUM_BLOCKS>;
+
+        /// @brief Recomputes the directory from the bits
+        constexpr void rebuild() noexcept
+        {
+            const auto& storage = m_bits.storage();
+            Rank_t total = 0;
+            for (size_t block = 0; block < NUM_BLOCKS; ++block)
+            {
+                m_directory[block] = total;
+                const size_t end = std::min(storage.size(), (block + 1) * BLOCK_CHUNKS);
+                for (size_t chunk = block * BLOCK_CHUNKS; chunk < end; ++chunk)
+                    total += static_cast<Rank_t>(std::popcount(storage[chunk]));
+            }
+        }
+    public:
+        constexpr RankedBitSet() noexcept : m_bits(), m_directory() {}
+        /// @param bits The bits to index
+        constexpr explicit RankedBitSet(const BitSet<N>& bits) noexcept :
+            m_bits(bits), m_directory()
+        {
+            rebuild();
+        }
+
+        /* ACCESSORS */
+
+        /// @return The number of 1 bits
+        constexpr size_t count() const noexcept
+        {
+            return rank(N);
+        }
+        /// @param pos The end of the counted range, at most N
+        /// @return The number of 1 bits before pos
+        constexpr size_t rank(size_t pos) const noexcept
+        {
+            BITSET_ASSERT(pos <= N);
+            const auto& storage = m_bits.storage();
+            const size_t chunk = pos / 64;
+            // pos == N may be the end of the last block
+            const size_t block = std::min(pos / BLOCK_BITS, NUM_BLOCKS - 1);
+            size_t result = m_directory[block];
+            for (size_t i = block * BLOCK_CHUNKS; i < chunk; ++i)
+                result += std::popcount(storage[i]);
+            if (pos % 64 != 0)
+                result += std::popcount(static_cast<uint64_t>(storage[chunk]) & ~(~0ull << (pos % 64)));
+            return result;
+        }
+        /// @brief Tests the bit at a an index. Does not perform a bounds
+        /// check in release
+        /// @param pos The bit position
+        /// @return The bit's value
+        constexpr bool test(size_t pos) const noexcept
+        {
+            return m_bits.test(pos);
+        }
+        /// @return The indexed bits
+        constexpr const BitSet<N>& bits() const noexcept
+        {
+            return m_bits;
+        }
+
+        /* CAPACITY */
+
+        constexpr size_t size() const noexcept { return N; }
+
+        /* MODIFIERS */
+
+        /// @brief Sets the bit as pos to value, updating the counts of the
+        /// following blocks
+        RankedBitSet& set(size_t pos, bool value = true) noexcept
+        {
+            BITSET_ASSERT(pos < N);
+            if (m_bits.test(pos) == value)
+                return *this;
+            m_bits.set(pos, value);
+            for (size_t block = pos / BLOCK_BITS + 1; block < NUM_BLOCKS; ++block)
+                m_directory[block] = value ? m_directory[block] + 1 : m_directory[block] - 1;
+            return *this;
+        }
+        /// @brief Sets the bit at pos to 0, updating the counts of the
+        /// following blocks
+        RankedBitSet& reset(size_t pos) noexcept
+        {
+            return set(pos, false);
+        }
+
+        /* OPERATORS*/
+
+        /// @brief Fetches the bit at a an index. Does not perform a bounds
+        /// check in release
+        /// @param pos The bit position
+        /// @return The bit's value
+        constexpr bool operator[](size_t pos) const
+        {
+            return m_bits[pos];
+        }
+
+        constexpr bool operator==(const RankedBitSet<N>& other) const noexcept
+        {
+            return m_bits == other.m_bits;
+        }
+    private:
+        /// @brief The indexed bits
+        BitSet<N> m_bits;
+        /// @brief The number of 1 bits before each block
+        Directory_t m_directory;
+    };
+}
+
+#endif
@@ -0,0 +1,117 @@
+/// @file slot_allocator.hpp
+/// @brief Lowest-slot allocation with generational handles
+
+#ifndef SLOT_ALLOCATOR_H_
+#define SLOT_ALLOCATOR_H_
+
+#include "better_bitset.hpp"
+
+namespace better_bitset
+{
+    /// @brief Hands out the lowest free slot of N as a handle that packs the
+    /// slot index in the low bits with the generation of the slot above it.
+    /// Releasing a slot bumps its generation, so handles to a slot that has
+    /// since been reused no longer validate
+    /// @tparam Handle_t The unsigned handle type, which must leave at least
+    /// two generation bits above the slot index
+    template<size_t N, std::unsigned_integral Handle_t = uint64_t>
+        requires (N > 0 && std::bit_width(N - 1) + 2 <= std::numeric_limits<Handle_t>::digits)
+    class SlotAllocator
+    {
+    public:
+        /// @brief The number of low handle bits holding the slot index
+        constexpr static size_t INDEX_BITS = std::bit_width(N - 1);
+        /// @brief The number of high handle bits holding the generation
+        constexpr static size_t GENERATION_BITS = std::numeric_limits<Handle_t>::digits - INDEX_BITS;
+        /// @brief A handle that never validates
+        constexpr static Handle_t INVALID = std::numeric_limits<Handle_t>::max();
+    private:
+        /// @brief The stored generation type
+        using Generation_t = std::conditional_t<(GENERATION_BITS <= 8), uint8_t,
+            std::conditional_t<(GENERATION_BITS <= 16), uint16_t,
+            std::conditional_t<(GENERATION_BITS <= 32), uint32_t, uint64_t>>>;
+        /// @brief The mask of the index bits of a handle
+        constexpr static Handle_t INDEX_MASK = static_cast<Handle_t>((Handle_t(1) << INDEX_BITS) - 1);
+        /// @brief The largest generation used. The all-ones generation is
+        /// skipped so that no handle equals INVALID
+        constexpr static Generation_t LAST_GENERATION =
+            static_cast<Generation_t>(std::numeric_limits<Handle_t>::max() >> INDEX_BITS) - 1;
+
+        /// @return The handle of a slot in its current generation
+        constexpr Handle_t handle(size_t index) const noexcept
+        {
+            return static_cast<Handle_t>((static_cast<Handle_t>(m_generations[index]) << INDEX_BITS) | index);
+        }
+    public:
+        SlotAllocator() noexcept : m_slots(), m_generations() {}
+
+        /* ACCESSORS */
+
+        /// @param handle A handle returned by claim
+        /// @return The slot index of the handle
+        constexpr static size_t index(Handle_t handle) noexcept
+        {
+            return handle & INDEX_MASK;
+        }
+        /// @param handle A handle returned by claim, or INVALID
+        /// @return True if the slot of the handle is claimed and has not been
+        /// released since the handle was returned
+        bool validate(Handle_t handle) const noexcept
+        {
+            const size_t slot = index(handle);
+            return slot < N && m_slots.test(slot) && handle == this->handle(slot);
+        }
+        /// @return The number of claimed slots
+        size_t count() const noexcept
+        {
+            return m_slots.count();
+        }
+        /// @return True if every slot is claimed
+        bool full() const noexcept
+        {
+            return m_slots.all();
+        }
+        /// @return The occupancy of the slots
+        const BitSet<N>& slots() const noexcept
+        {
+            return m_slots;
+        }
+
+        /* CAPACITY */
+
+        constexpr size_t size() const noexcept { return N; }
+
+        /* MODIFIERS */
+
+        /// @brief Claims the lowest free slot
+        /// @return The handle of the slot, or INVALID if every slot is
+        /// claimed
+        Handle_t claim() noexcept
+        {
+            const size_t slot = m_slots.claim_first_zero();
+            return slot == N ? INVALID : handle(slot);
+        }
+        /// @brief Releases the slot of a valid handle and bumps its
+        /// generation, wrapping around after LAST_GENERATION
+        /// @param handle A handle returned by claim
+        /// @return False if the handle was not valid, in which case nothing
+        /// is released
+        bool release(Handle_t handle) noexcept
+        {
+            if (!validate(handle))
+                return false;
+            const size_t slot = index(handle);
+            m_slots.release(slot);
+            Generation_t& generation = m_generations[slot];
+            generation = generation == LAST_GENERATION ? 0 : generation + 1;
+            return true;
+        }
+    private:
+        /// @brief The claimed slots
+        BitSet<N> m_slots;
+        /// @brief The current generation of every slot
+        std::array<Generation_t, N> m_generations;
+    };
+}
+
+#endif
@@ -0,0 +1,118 @@
+/// @file slot_magazine.hpp
+/// @brief A per-thread cache of slots claimed from a shared atomic bitset
+
+#ifndef SLOT_MAGAZINE_H_
+#define SLOT_MAGAZINE_H_
+
+#include "better_bitset.hpp"
+
+namespace better_bitset
+{
+    /// @brief Caches up to CAPACITY slots claimed from a shared
+    /// AtomicBitSet or AtomicHierarchicalBitSet, so that most claims and
+    /// releases by one thread do not touch the shared set. Refills take up
+    /// to a whole chunk of free slots in one compare-exchange, and releases
+    /// go back to the magazine until it is full, at which point the older
+    /// half is returned with one atomic operation per chunk. Not thread
+    /// safe itself: every thread should have its own magazine, for
+    /// instance as a thread_local
+    /// @tparam Shared_t The shared set
+    /// @tparam CAPACITY The largest number of slots held
+    template<typename Shared_t, size_t CAPACITY = 64> requires (CAPACITY > 0)
+        class SlotMagazine
+    {
+    private:
+        /// @brief Returns slots to the shared set, releasing the slots of
+        /// each chunk with one atomic operation
+        /// @param count The number of slots to return from the bottom of the
+        /// magazine
+        void give_back(size_t count) noexcept
+        {
+            std::sort(m_slots.begin(), m_slots.begin() + count);
+            for (size_t i = 0; i < count;)
+            {
+                const size_t chunk = m_slots[i] / 64;
+                uint64_t mask = 0;
+                for (; i < count && m_slots[i] / 64 == chunk; ++i)
+                    mask |= 1ull << (m_slots[i] % 64);
+                m_shared.release_mask(chunk, mask);
+            }
+            std::move(m_slots.begin() + count, m_slots.begin() + m_size, m_slots.begin());
+            m_size -= count;
+        }
+    public:
+        /// @param shared The set to claim slots from, which must outlive the
+        /// magazine
+        explicit SlotMagazine(Shared_t& shared) noexcept :
+            m_shared(shared), m_slots(), m_size(0) {}
+        SlotMagazine(const SlotMagazine&) = delete;
+        SlotMagazine& operator=(const SlotMagazine&) = delete;
+        /// @brief Returns the held slots to the shared set
+        ~SlotMagazine()
+        {
+            drain();
+        }
+
+        /* ACCESSORS */
+
+        /// @return The number of slots held
+        size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+        /* CAPACITY */
+
+        constexpr size_t capacity() const noexcept { return CAPACITY; }
+
+        /* MODIFIERS */
+
+        /// @brief Takes a slot from the magazine, refilling it from the
+        /// shared set when empty. Refills take the lowest free slots of
+        /// the first chunk with a zero, and slots are handed out lowest
+        /// first
+        /// @return The slot, or the size of the shared set if it is full
+        size_t claim() noexcept
+        {
+            if (m_size == 0)
+            {
+                size_t chunk;
+                uint64_t claimed = m_shared.claim_word(std::min<size_t>(CAPACITY, 64), chunk);
+                if (claimed == 0)
+                    return m_shared.size();
+                // pushed highest first, so that the lowest slot is on top
+                while (claimed != 0)
+                {
+                    const size_t bit = 63 - std::countl_zero(claimed);
+                    m_slots[m_size++] = chunk * 64 + bit;
+                    claimed &= ~(1ull << bit);
+                }
+            }
+            return m_slots[--m_size];
+        }
+        /// @brief Puts a slot back into the magazine, first returning the
+        /// older half of the slots to the shared set if it is full
+        /// @param pos A slot returned by claim of any magazine of the same
+        /// shared set
+        void release(size_t pos) noexcept
+        {
+            if (m_size == CAPACITY)
+                give_back((CAPACITY + 1) / 2);
+            m_slots[m_size++] = pos;
+        }
+        /// @brief Returns every held slot to the shared set
+        void drain() noexcept
+        {
+            give_back(m_size);
+        }
+    private:
+        /// @brief The shared set
+        Shared_t& m_shared;
+        /// @brief The held slots, as a stack
+        std::array<size_t, CAPACITY> m_slots;
+        /// @brief The number of held slots
+        size_t m_size;
+    };
+}
+
+#endif
@@ -1,8 +1,14 @@
 #include <benchmark/benchmark.h>
 
+#include <atomic_bitset.hpp>
+#include <atomic_hierarchical_bitset.hpp>
 #include <better_bitset.hpp>
+#include <hierarchical_bitset.hpp>
 
+#include <array>
+#include <bit>
 #include <bitset>
+#include <memory>
 #include <random>
 #include <vector>
 
@@ -20,6 +26,47 @@ inline size_t find_one(const std::bitset<N>& bitset)
     return N;
 }
 
+template<size_t N>
+inline size_t find_one_loop(const better_bitset::BitSet<N>& bitset)
+{
+    // chunk by chunk scan with an early return, as used before unrolling
+    size_t pos = 0;
+    for (auto chunk : bitset.storage())
+    {
+        const size_t chunk_pos = std::countr_zero(chunk);
+        pos += chunk_pos;
+        if (chunk_pos != sizeof(chunk) * 8)
+            return pos;
+    }
+    return N;
+}
+
+/// @brief Enough bitsets that the branch predictor cannot learn the sequence
+constexpr size_t RANDOM_ITERATIONS = 1 << 16;
+
+/// @brief Generates bitsets whose first one lands at a uniformly random
+/// position, so that the chunk holding it is unpredictable
+template<size_t N>
+std::vector<better_bitset::BitSet<N>> random_first_bitsets()
+{
+    std::vector<better_bitset::BitSet<N>> bitsets;
+    bitsets.reserve(RANDOM_ITERATIONS);
+    std::random_device rd;
+    std::default_random_engine eng(rd());
+    std::uniform_int_distribution<size_t> first(0, N - 1);
+    std::bernoulli_distribution b(0.5);
+    for (size_t i = 0; i < RANDOM_ITERATIONS; ++i)
+    {
+        better_bitset::BitSet<N> bitset;
+        const size_t pos = first(eng);
+        bitset.set(pos);
+        for (size_t j = pos + 1; j < N; ++j)
+            bitset.set(j, b(eng));
+        bitsets.push_back(bitset);
+    }
+    return bitsets;
+}
+
 template<size_t N>
 static void BM_Bitset(benchmark::State& state)
 {
@@ -92,4 +139,126 @@ BENCHMARK_TEMPLATE(BM_BBitset, 2048);
 BENCHMARK_TEMPLATE(BM_BBitset, 4096);
 BENCHMARK_TEMPLATE(BM_BBitset, 8192);
 
+template<size_t N>
+static void BM_BBitsetLoopRandom(benchmark::State& state)
+{
+    const auto bitsets = random_first_bitsets<N>();
+    for (size_t i = 0; state.KeepRunning() == true; ++i)
+    {
+        for (size_t j = 0; j < RANDOM_ITERATIONS; ++j)
+            benchmark::DoNotOptimize(find_one_loop(bitsets[j]));
+    }
+}
+BENCHMARK_TEMPLATE(BM_BBitsetLoopRandom, 96);
+BENCHMARK_TEMPLATE(BM_BBitsetLoopRandom, 128);
+BENCHMARK_TEMPLATE(BM_BBitsetLoopRandom, 256);
+BENCHMARK_TEMPLATE(BM_BBitsetLoopRandom, 512);
+
+template<size_t N>
+static void BM_BBitsetRandom(benchmark::State& state)
+{
+    const auto bitsets = random_first_bitsets<N>();
+    for (size_t i = 0; state.KeepRunning() == true; ++i)
+    {
+        for (size_t j = 0; j < RANDOM_ITERATIONS; ++j)
+            benchmark::DoNotOptimize(bitsets[j].first_one());
+    }
+}
+BENCHMARK_TEMPLATE(BM_BBitsetRandom, 96);
+BENCHMARK_TEMPLATE(BM_BBitsetRandom, 128);
+BENCHMARK_TEMPLATE(BM_BBitsetRandom, 256);
+BENCHMARK_TEMPLATE(BM_BBitsetRandom, 512);
+
+template<size_t N>
+static void BM_BBitsetBatch(benchmark::State& state)
+{
+    // generate
+    std::vector<better_bitset::BitSet<N>> bitsets;
+    bitsets.reserve(ITERATIONS);
+    std::random_device rd;
+    std::default_random_engine eng(rd());
+    std::bernoulli_distribution b(AVG_ONES / N);
+    for (size_t i = 0; i < ITERATIONS; ++i)
+    {
+        better_bitset::BitSet<N> bitset;
+        for (size_t j = 0; j < N; ++j)
+            bitset.set(j, b(eng));
+        bitsets.push_back(bitset);
+    }
+    std::vector<uint16_t> positions(ITERATIONS);
+    for (size_t i = 0; state.KeepRunning() == true; ++i)
+    {
+        better_bitset::BitSet<N>::first_one_batch(bitsets, positions);
+        benchmark::DoNotOptimize(positions.data());
+    }
+}
+BENCHMARK_TEMPLATE(BM_BBitsetBatch, 4);
+BENCHMARK_TEMPLATE(BM_BBitsetBatch, 8);
+BENCHMARK_TEMPLATE(BM_BBitsetBatch, 16);
+BENCHMARK_TEMPLATE(BM_BBitsetBatch, 32);
+BENCHMARK_TEMPLATE(BM_BBitsetBatch, 64);
+
+template<size_t N>
+static void BM_HBitset(benchmark::State& state)
+{
+    // generate
+    std::vector<better_bitset::HierarchicalBitSet<N>> bitsets;
+    bitsets.reserve(ITERATIONS);
+    std::random_device rd;
+    std::default_random_engine eng(rd());
+    std::bernoulli_distribution b(AVG_ONES / N);
+    for (size_t i = 0; i < ITERATIONS; ++i)
+    {
+        better_bitset::HierarchicalBitSet<N> bitset;
+        for (size_t j = 0; j < N; ++j)
+            bitset.set(j, b(eng));
+        bitsets.push_back(bitset);
+    }
+    for (size_t i = 0; state.KeepRunning() == true; ++i)
+    {
+        for (size_t j = 0; j < ITERATIONS; ++j)
+            benchmark::DoNotOptimize(bitsets[j].first_one());
+    }
+}
+BENCHMARK_TEMPLATE(BM_HBitset, 64);
+BENCHMARK_TEMPLATE(BM_HBitset, 128);
+BENCHMARK_TEMPLATE(BM_HBitset, 256);
+BENCHMARK_TEMPLATE(BM_HBitset, 512);
+BENCHMARK_TEMPLATE(BM_HBitset, 1024);
+BENCHMARK_TEMPLATE(BM_HBitset, 2048);
+BENCHMARK_TEMPLATE(BM_HBitset, 4096);
+BENCHMARK_TEMPLATE(BM_HBitset, 8192);
+
+/// @brief The number of slots each thread holds between releases
+constexpr size_t HELD_SLOTS = 8;
+
+/// @brief Threads claiming and releasing slots of one shared set, so that
+/// contention on the chunks the claims land in shows up as time per claim
+template<typename Shared_t, bool HINTED>
+static void BM_AtomicClaim(benchmark::State& state)
+{
+    // shared by every thread of a run, and left empty by each of them
+    static const std::unique_ptr<Shared_t> shared = std::make_unique<Shared_t>();
+    size_t hint = 0;
+    if constexpr (HINTED)
+        hint = state.thread_index() * shared->size() / state.threads();
+    std::array<size_t, HELD_SLOTS> held;
+    for (auto _ : state)
+    {
+        for (size_t& slot : held)
+        {
+            if constexpr (HINTED)
+                slot = shared->claim_first_zero(hint);
+            else
+                slot = shared->claim_first_zero();
+        }
+        for (size_t slot : held)
+            shared->release(slot);
+    }
+    state.SetItemsProcessed(state.iterations() * HELD_SLOTS);
+}
+BENCHMARK_TEMPLATE(BM_AtomicClaim, better_bitset::AtomicBitSet<4096>, false)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_AtomicClaim, better_bitset::AtomicHierarchicalBitSet<1 << 20>, false)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_AtomicClaim, better_bitset::AtomicHierarchicalBitSet<1 << 20>, true)->ThreadRange(1, 8)->UseRealTime();
+
 BENCHMARK_MAIN();
\ No newline at end of file
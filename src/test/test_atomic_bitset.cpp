@@ -0,0 +1,156 @@
+
+#include <atomic_bitset.hpp>
+
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+constexpr size_t NUM_THREADS = 8;
+
+template <size_t SIZE>
+void fail(const char* name, size_t actual, size_t expected) {
+    constexpr size_t numChunks = (SIZE + 63) / 64;
+    std::cerr << name << "=" << actual
+              << ", expected=" << expected
+              << ", size=" << SIZE
+              << ", NUM_CHUNKS=" << numChunks
+              << std::endl;
+    abort();
+}
+
+template <size_t SIZE>
+void runTest(std::default_random_engine& eng) {
+    for (double density : { 0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0 }) {
+        std::bernoulli_distribution b(density);
+        better_bitset::BitSet<SIZE> initial;
+        for (size_t i = 0; i < SIZE; ++i)
+            initial.set(i, b(eng));
+
+        // single threaded claims match BitSet
+        {
+            better_bitset::AtomicBitSet<SIZE> abs(initial);
+            better_bitset::BitSet<SIZE> bs = initial;
+            if (abs.count() != bs.count())
+                fail<SIZE>("abs.count()", abs.count(), bs.count());
+            for (size_t step = 0; step <= SIZE; ++step) {
+                const size_t expected = bs.claim_first_zero();
+                const size_t actual = abs.claim_first_zero();
+                if (actual != expected)
+                    fail<SIZE>("abs.claim_first_zero()", actual, expected);
+                if (actual == SIZE)
+                    break;
+            }
+            if (!(abs.load() == bs))
+                fail<SIZE>("abs.load().count()", abs.load().count(), bs.count());
+        }
+
+        // every free bit is claimed by exactly one thread
+        better_bitset::AtomicBitSet<SIZE> abs(initial);
+        std::vector<std::vector<size_t>> claimed(NUM_THREADS);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < NUM_THREADS; ++t) {
+            threads.emplace_back([&abs, &claims = claimed[t]] {
+                for (size_t pos = abs.claim_first_zero(); pos != SIZE; pos = abs.claim_first_zero())
+                    claims.push_back(pos);
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+        better_bitset::BitSet<SIZE> seen = initial;
+        for (const std::vector<size_t>& claims : claimed) {
+            for (size_t pos : claims) {
+                if (seen.test(pos))
+                    fail<SIZE>("claimed twice or preset", pos, SIZE);
+                seen.set(pos);
+            }
+        }
+        if (!seen.all())
+            fail<SIZE>("claimed count", seen.count(), SIZE);
+        if (!abs.load().all())
+            fail<SIZE>("abs.count()", abs.count(), SIZE);
+    }
+}
+
+// threads repeatedly claim runs, check that nobody else owns any of their
+// slots, and release them again
+template <size_t SIZE>
+void runRunTest() {
+    better_bitset::AtomicBitSet<SIZE> abs;
+    better_bitset::BitSet<SIZE> bs;
+    // single threaded claims match BitSet
+    for (size_t k : { 1, 3, 64, 65, 7, 130, 2, 200, 1 }) {
+        const size_t expected = bs.claim_run(k);
+        const size_t actual = abs.claim_run(k);
+        if (actual != expected)
+            fail<SIZE>("abs.claim_run()", actual, expected);
+    }
+    bs.for_each_one([&abs](size_t pos) { abs.release(pos); });
+    std::vector<std::atomic<size_t>> owners(SIZE);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&abs, &owners, t] {
+            for (size_t step = 0; step < 5000; ++step) {
+                const size_t k = (step * 7 + t) % std::min<size_t>(SIZE, 100) + 1;
+                const size_t pos = abs.claim_run(k);
+                if (pos == SIZE)
+                    continue;
+                for (size_t i = pos; i < pos + k; ++i) {
+                    if (owners[i].exchange(t + 1, std::memory_order_relaxed) != 0)
+                        fail<SIZE>("owned slot claimed in a run", i, SIZE);
+                }
+                for (size_t i = pos; i < pos + k; ++i)
+                    owners[i].store(0, std::memory_order_relaxed);
+                abs.release_range(pos, k);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    if (abs.count() != 0)
+        fail<SIZE>("abs.count() after run churn", abs.count(), 0);
+}
+
+// threads repeatedly claim a slot, check that nobody else owns it, and
+// release it again
+template <size_t SIZE>
+void runChurnTest() {
+    better_bitset::AtomicBitSet<SIZE> abs;
+    std::vector<std::atomic<size_t>> owners(SIZE);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&abs, &owners, t] {
+            for (size_t step = 0; step < 20000; ++step) {
+                const size_t pos = abs.claim_first_zero();
+                if (pos == SIZE)
+                    continue;
+                if (owners[pos].exchange(t + 1, std::memory_order_relaxed) != 0)
+                    fail<SIZE>("owned slot claimed", pos, SIZE);
+                owners[pos].store(0, std::memory_order_relaxed);
+                abs.release(pos);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    if (abs.count() != 0)
+        fail<SIZE>("abs.count() after churn", abs.count(), 0);
+}
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    (runTest<SIZES>(eng), ...);
+    (runChurnTest<SIZES>(), ...);
+    (runRunTest<SIZES>(), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 96, 127, 128, 129,
+             255, 256, 257, 1000, 1024, 8192>(eng);
+
+    return 0;
+}
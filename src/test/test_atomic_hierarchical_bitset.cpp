@@ -0,0 +1,167 @@
+
+#include <atomic_hierarchical_bitset.hpp>
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+constexpr size_t NUM_THREADS = 8;
+
+template <size_t SIZE>
+void fail(const char* name, size_t actual, size_t expected) {
+    std::cerr << name << "=" << actual
+              << ", expected=" << expected
+              << ", size=" << SIZE
+              << std::endl;
+    abort();
+}
+
+// single threaded claims and releases match BitSet
+template <size_t SIZE>
+void runTest(std::default_random_engine& eng) {
+    auto ahbs = std::make_unique<better_bitset::AtomicHierarchicalBitSet<SIZE>>();
+    auto bs = std::make_unique<better_bitset::BitSet<SIZE>>();
+    std::uniform_int_distribution<size_t> position(0, SIZE - 1);
+    // fills up with releases in between, so that chunks and summary words
+    // go full and free again
+    for (size_t step = 0; step <= SIZE + SIZE / 4; ++step) {
+        const size_t expected = bs->claim_first_zero();
+        const size_t actual = ahbs->claim_first_zero();
+        if (actual != expected)
+            fail<SIZE>("ahbs.claim_first_zero()", actual, expected);
+        if (step % 4 == 3) {
+            const size_t pos = position(eng);
+            if (bs->test(pos)) {
+                bs->release(pos);
+                ahbs->release(pos);
+            }
+        }
+    }
+    if (ahbs->count() != bs->count())
+        fail<SIZE>("ahbs.count()", ahbs->count(), bs->count());
+    for (size_t pos = 0; pos < SIZE; ++pos) {
+        if (ahbs->test(pos) != bs->test(pos))
+            fail<SIZE>("ahbs.test()", pos, bs->test(pos));
+    }
+}
+
+// hinted claims start in the chunk of the hint, and fill the set with
+// every bit claimed once
+template <size_t SIZE>
+void runHintTest(std::default_random_engine& eng) {
+    auto ahbs = std::make_unique<better_bitset::AtomicHierarchicalBitSet<SIZE>>();
+    auto seen = std::make_unique<better_bitset::BitSet<SIZE>>();
+    std::uniform_int_distribution<size_t> position(0, SIZE - 1);
+    const size_t hint = position(eng);
+    if (ahbs->claim_first_zero(hint) != hint / 64 * 64)
+        fail<SIZE>("ahbs.claim_first_zero(hint) when empty", ahbs->count(), hint / 64 * 64);
+    seen->set(hint / 64 * 64);
+    for (size_t i = 1; i < SIZE; ++i) {
+        const size_t pos = ahbs->claim_first_zero(position(eng));
+        if (pos == SIZE || seen->test(pos))
+            fail<SIZE>("ahbs.claim_first_zero(hint)", pos, SIZE);
+        seen->set(pos);
+    }
+    if (ahbs->claim_first_zero(position(eng)) != SIZE)
+        fail<SIZE>("ahbs.claim_first_zero(hint) when full", 0, SIZE);
+}
+
+// every bit is claimed by exactly one thread, and claiming from a full set
+// fails. Threads either all start at the front or each start at their own
+// hint
+template <size_t SIZE, bool HINTED>
+void runClaimAllTest() {
+    auto ahbs = std::make_unique<better_bitset::AtomicHierarchicalBitSet<SIZE>>();
+    std::vector<std::vector<size_t>> claimed(NUM_THREADS);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&ahbs, &claims = claimed[t], t] {
+            const size_t hint = HINTED ? t * SIZE / NUM_THREADS : 0;
+            for (size_t pos = ahbs->claim_first_zero(hint); pos != SIZE; pos = ahbs->claim_first_zero(hint))
+                claims.push_back(pos);
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    auto seen = std::make_unique<better_bitset::BitSet<SIZE>>();
+    for (const std::vector<size_t>& claims : claimed) {
+        for (size_t pos : claims) {
+            if (seen->test(pos))
+                fail<SIZE>("claimed twice", pos, SIZE);
+            seen->set(pos);
+        }
+    }
+    if (!seen->all())
+        fail<SIZE>("claimed count", seen->count(), SIZE);
+    if (ahbs->count() != SIZE)
+        fail<SIZE>("ahbs.count()", ahbs->count(), SIZE);
+}
+
+// threads repeatedly claim a few slots, check that nobody else owns them,
+// and release them again. Afterwards every slot can be claimed again
+template <size_t SIZE>
+void runChurnTest() {
+    auto ahbs = std::make_unique<better_bitset::AtomicHierarchicalBitSet<SIZE>>();
+    std::vector<std::atomic<size_t>> owners(SIZE);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&ahbs, &owners, t] {
+            std::vector<size_t> held;
+            for (size_t step = 0; step < 20000; ++step) {
+                const size_t pos = ahbs->claim_first_zero();
+                if (pos != SIZE) {
+                    if (owners[pos].exchange(t + 1, std::memory_order_relaxed) != 0)
+                        fail<SIZE>("owned slot claimed", pos, SIZE);
+                    held.push_back(pos);
+                }
+                if (pos == SIZE || held.size() > step % 7) {
+                    for (size_t released : held) {
+                        owners[released].store(0, std::memory_order_relaxed);
+                        ahbs->release(released);
+                    }
+                    held.clear();
+                }
+            }
+            for (size_t released : held) {
+                owners[released].store(0, std::memory_order_relaxed);
+                ahbs->release(released);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    if (ahbs->count() != 0)
+        fail<SIZE>("ahbs.count() after churn", ahbs->count(), 0);
+    for (size_t i = 0; i < SIZE; ++i) {
+        const size_t pos = ahbs->claim_first_zero();
+        if (pos != i)
+            fail<SIZE>("ahbs.claim_first_zero() after churn", pos, i);
+    }
+    if (ahbs->claim_first_zero() != SIZE)
+        fail<SIZE>("ahbs.claim_first_zero() when full", 0, SIZE);
+}
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    (runTest<SIZES>(eng), ...);
+    (runHintTest<SIZES>(eng), ...);
+    (runClaimAllTest<SIZES, false>(), ...);
+    (runClaimAllTest<SIZES, true>(), ...);
+    (runChurnTest<SIZES>(), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 96, 127, 128, 129,
+             255, 256, 257, 1000, 1024, 4095, 4096, 4097, 8192, 262145>(eng);
+    runClaimAllTest<(1 << 20), false>();
+    runClaimAllTest<(1 << 20), true>();
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+
+#include <better_bitset.hpp>
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+template <size_t SIZE>
+void runTest(std::default_random_engine& eng) {
+    using BitSet = better_bitset::BitSet<SIZE>;
+    for (double density : { 0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0 }) {
+        std::bernoulli_distribution b(density);
+        for (size_t count : { 0, 1, 3, 4, 7, 8, 15, 16, 31, 32, 33, 100, 1000 }) {
+            std::vector<BitSet> bitsets(count);
+            for (BitSet& bs : bitsets) {
+                for (size_t i = 0; i < SIZE; ++i)
+                    bs.set(i, b(eng));
+            }
+            std::vector<uint16_t> ones(count);
+            std::vector<uint16_t> zeros(count);
+            BitSet::first_one_batch(bitsets, ones);
+            BitSet::first_zero_batch(bitsets, zeros);
+            for (size_t i = 0; i < count; ++i) {
+                if (ones[i] != bitsets[i].first_one() || zeros[i] != bitsets[i].first_zero()) {
+                    std::cerr << "first_one_batch()[" << i << "]=" << ones[i]
+                              << ", first_zero_batch()[" << i << "]=" << zeros[i]
+                              << ", expected=" << bitsets[i].first_one() << "/" << bitsets[i].first_zero()
+                              << ", count=" << count
+                              << ", density=" << density
+                              << ", size=" << SIZE
+                              << std::endl;
+                    abort();
+                }
+            }
+        }
+    }
+}
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    (runTest<SIZES>(eng), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 48, 63, 64>(eng);
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+
+#include <better_bitset.hpp>
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+template <size_t SIZE>
+size_t firstZero(const better_bitset::BitSet<SIZE>& bs) {
+    for (size_t i = 0; i < SIZE; ++i) {
+        if (!bs.test(i))
+            return i;
+    }
+    return SIZE;
+}
+
+template <size_t SIZE>
+void check(const char* name, size_t actual, size_t expected, const better_bitset::BitSet<SIZE>& bs,
+           const better_bitset::BitSet<SIZE>& expectedBs, double density) {
+    constexpr size_t numChunks = (SIZE + 63) / 64;
+    if (actual != expected || !(bs == expectedBs)) {
+        std::cerr << name << "=" << actual
+                  << ", expected=" << expected
+                  << (bs == expectedBs ? "" : ", bits differ")
+                  << ", density=" << density
+                  << ", size=" << SIZE
+                  << ", NUM_CHUNKS=" << numChunks
+                  << std::endl;
+        abort();
+    }
+}
+
+template <size_t SIZE>
+void runTest(std::default_random_engine& eng) {
+    for (double density : { 0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0 }) {
+        std::bernoulli_distribution b(density);
+        better_bitset::BitSet<SIZE> bs;
+        for (size_t i = 0; i < SIZE; ++i)
+            bs.set(i, b(eng));
+        const better_bitset::BitSet<SIZE> initial = bs;
+
+        // claims until full, and one more
+        for (size_t step = 0; step <= SIZE; ++step) {
+            better_bitset::BitSet<SIZE> expectedBs = bs;
+            const size_t expected = firstZero(bs);
+            if (expected != SIZE)
+                expectedBs.set(expected);
+            const size_t actual = bs.claim_first_zero();
+            check("bs.claim_first_zero()", actual, expected, bs, expectedBs, density);
+            if (actual == SIZE)
+                break;
+        }
+
+        // claiming in batches matches claiming one by one
+        better_bitset::BitSet<SIZE> batched = initial;
+        better_bitset::BitSet<SIZE> single = initial;
+        std::uniform_int_distribution<size_t> batch(0, 100);
+        std::vector<size_t> positions;
+        for (;;) {
+            const size_t k = batch(eng);
+            positions.assign(k, SIZE);
+            const size_t claimed = batched.claim_n(k, positions);
+            for (size_t i = 0; i < k; ++i) {
+                const size_t expected = single.claim_first_zero();
+                check("bs.claim_n()", i < claimed ? positions[i] : SIZE, expected, batched, batched, density);
+                if (expected == SIZE)
+                    break;
+            }
+            check("bs.claim_n() bits", claimed, claimed, batched, single, density);
+            if (batched.all())
+                break;
+        }
+
+        // claiming runs matches finding them and setting every bit, and
+        // released runs are free again
+        better_bitset::BitSet<SIZE> runs = initial;
+        better_bitset::BitSet<SIZE> expectedRuns = initial;
+        std::uniform_int_distribution<size_t> length(1, std::min<size_t>(SIZE, 150));
+        std::vector<std::pair<size_t, size_t>> claimedRuns;
+        for (size_t step = 0; step < 64; ++step) {
+            if (step % 3 == 2 && !claimedRuns.empty()) {
+                const auto [pos, k] = claimedRuns[step % claimedRuns.size()];
+                claimedRuns.erase(claimedRuns.begin() + step % claimedRuns.size());
+                runs.release_range(pos, k);
+                for (size_t i = pos; i < pos + k; ++i)
+                    expectedRuns.reset(i);
+                check("bs.release_range()", pos, pos, runs, expectedRuns, density);
+                continue;
+            }
+            const size_t k = length(eng);
+            const size_t expected = expectedRuns.find_zero_run(k);
+            if (expected != SIZE) {
+                for (size_t i = expected; i < expected + k; ++i)
+                    expectedRuns.set(i);
+                claimedRuns.emplace_back(expected, k);
+            }
+            check("bs.claim_run()", runs.claim_run(k), expected, runs, expectedRuns, density);
+        }
+
+        // a released slot is the next one claimed
+        std::uniform_int_distribution<size_t> slot(0, SIZE - 1);
+        for (size_t step = 0; step < 16; ++step) {
+            const size_t pos = slot(eng);
+            bs.release(pos);
+            better_bitset::BitSet<SIZE> expectedBs = bs;
+            expectedBs.set(pos);
+            check("bs.claim_first_zero() after release", bs.claim_first_zero(), pos, bs, expectedBs, density);
+        }
+    }
+}
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    (runTest<SIZES>(eng), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 96, 127, 128, 129,
+             255, 256, 257, 1000, 1024, 8192>(eng);
+
+    return 0;
+}
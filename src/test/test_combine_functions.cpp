@@ -0,0 +1,74 @@
+
+#include <better_bitset.hpp>
+
+#include <iostream>
+#include <random>
+
+
+template <size_t SIZE, typename Func>
+size_t findOne(Func func) {
+    for (size_t i = 0; i < SIZE; ++i) {
+        if (func(i))
+            return i;
+    }
+    return SIZE;
+}
+
+template <size_t SIZE>
+void check(const char* name, size_t actual, size_t expected, double density) {
+    constexpr size_t numChunks = (SIZE + 63) / 64;
+    if (actual != expected) {
+        std::cerr << name << "=" << actual
+                  << ", expected=" << expected
+                  << ", density=" << density
+                  << ", size=" << SIZE
+                  << ", NUM_CHUNKS=" << numChunks
+                  << std::endl;
+        abort();
+    }
+}
+
+template <size_t SIZE>
+void runTest(std::default_random_engine& eng) {
+    using better_bitset::BitSet;
+    for (double density : { 0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0 }) {
+        std::bernoulli_distribution b(density);
+        BitSet<SIZE> x;
+        BitSet<SIZE> y;
+        BitSet<SIZE> z;
+        for (size_t i = 0; i < SIZE; ++i) {
+            x.set(i, b(eng));
+            y.set(i, b(eng));
+            z.set(i, b(eng));
+        }
+
+        check<SIZE>("first_one_and(x, y)", first_one_and(x, y),
+            findOne<SIZE>([&](size_t i) { return x.test(i) && y.test(i); }), density);
+        check<SIZE>("first_one_and(x, y, z)", first_one_and(x, y, z),
+            findOne<SIZE>([&](size_t i) { return x.test(i) && y.test(i) && z.test(i); }), density);
+        check<SIZE>("first_one_or(x, y)", first_one_or(x, y),
+            findOne<SIZE>([&](size_t i) { return x.test(i) || y.test(i); }), density);
+        check<SIZE>("first_one_xor(x, y, z)", first_one_xor(x, y, z),
+            findOne<SIZE>([&](size_t i) { return x.test(i) ^ y.test(i) ^ z.test(i); }), density);
+        check<SIZE>("first_one_andnot(x, y)", first_one_andnot(x, y),
+            findOne<SIZE>([&](size_t i) { return x.test(i) && !y.test(i); }), density);
+        check<SIZE>("first_one_of(~x & ~y | z)",
+            BitSet<SIZE>::first_one_of([](auto a, auto b, auto c) { return (~a & ~b) | c; }, x, y, z),
+            findOne<SIZE>([&](size_t i) { return (!x.test(i) && !y.test(i)) || z.test(i); }), density);
+    }
+}
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    (runTest<SIZES>(eng), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 96, 127, 128, 129,
+             255, 256, 257, 1000, 1024, 8192>(eng);
+
+    return 0;
+}
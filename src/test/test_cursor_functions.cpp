@@ -0,0 +1,64 @@
+
+#include <better_bitset.hpp>
+
+#include <iostream>
+#include <random>
+
+
+template <size_t SIZE>
+void runTest(std::default_random_engine& eng) {
+    constexpr size_t numChunks = (SIZE + 63) / 64;
+    std::uniform_int_distribution<size_t> position(0, SIZE - 1);
+    for (double density : { 0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0 }) {
+        std::bernoulli_distribution b(density);
+        better_bitset::BitSet<SIZE> bs;
+        for (size_t i = 0; i < SIZE; ++i)
+            bs.set(i, b(eng));
+
+        // allocate until full, releasing a random slot every other step
+        size_t cursor = position(eng);
+        for (size_t i = 0; i < 2 * SIZE; ++i) {
+            const size_t start = cursor;
+            size_t expected = SIZE;
+            for (size_t offset = 0; offset < SIZE; ++offset) {
+                if (!bs.test((start + offset) % SIZE)) {
+                    expected = (start + offset) % SIZE;
+                    break;
+                }
+            }
+            const size_t actual = bs.find_zero_from_cursor(cursor);
+            const size_t expectedCursor = expected == SIZE ? start : (expected + 1) % SIZE;
+            if (actual != expected || cursor != expectedCursor) {
+                std::cerr << "bs.find_zero_from_cursor(" << start << ")=" << actual
+                          << ", cursor=" << cursor
+                          << ", expected=" << expected
+                          << ", expected cursor=" << expectedCursor
+                          << ", density=" << density
+                          << ", size=" << SIZE
+                          << ", NUM_CHUNKS=" << numChunks
+                          << std::endl;
+                abort();
+            }
+            if (actual == SIZE)
+                break;
+            bs.set(actual);
+            if (i % 2 == 1)
+                bs.reset(position(eng));
+        }
+    }
+}
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    (runTest<SIZES>(eng), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 96, 127, 128, 129,
+             255, 256, 257, 1000, 1024>(eng);
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+
+#include <better_bitset.hpp>
+
+#include <iostream>
+#include <random>
+
+
+template <size_t SIZE>
+size_t findNextDifference(const better_bitset::BitSet<SIZE>& x, const better_bitset::BitSet<SIZE>& y,
+                          size_t pos) {
+    for (size_t i = pos; i < SIZE; ++i) {
+        if (x.test(i) != y.test(i))
+            return i;
+    }
+    return SIZE;
+}
+
+template <size_t SIZE>
+void runTest(std::default_random_engine& eng) {
+    constexpr size_t numChunks = (SIZE + 63) / 64;
+    for (double density : { 0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0 }) {
+        std::bernoulli_distribution b(density);
+        std::bernoulli_distribution differ(0.01);
+        better_bitset::BitSet<SIZE> x;
+        better_bitset::BitSet<SIZE> y;
+        for (size_t i = 0; i < SIZE; ++i) {
+            const bool value = b(eng);
+            x.set(i, value);
+            y.set(i, differ(eng) ? !value : value);
+        }
+
+        const size_t expectedFirst = findNextDifference(x, y, 0);
+        if (x.first_difference(y) != expectedFirst) {
+            std::cerr << "x.first_difference(y)=" << x.first_difference(y)
+                      << ", expected=" << expectedFirst
+                      << ", density=" << density
+                      << ", size=" << SIZE
+                      << ", NUM_CHUNKS=" << numChunks
+                      << std::endl;
+            abort();
+        }
+        for (size_t pos = 0; pos <= SIZE; ++pos) {
+            const size_t actual = x.find_next_difference(y, pos);
+            const size_t expected = findNextDifference(x, y, pos);
+            if (actual != expected) {
+                std::cerr << "x.find_next_difference(y, " << pos << ")=" << actual
+                          << ", expected=" << expected
+                          << ", density=" << density
+                          << ", size=" << SIZE
+                          << ", NUM_CHUNKS=" << numChunks
+                          << std::endl;
+                abort();
+            }
+            // skip the equal run, as the reference scan is quadratic
+            pos = expected;
+        }
+    }
+}
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    (runTest<SIZES>(eng), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 96, 127, 128, 129,
+             255, 256, 257, 1000, 1024, 8192>(eng);
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+
+#include <better_bitset.hpp>
+#include <hierarchical_bitset.hpp>
+
+#include <iostream>
+#include <memory>
+#include <random>
+
+
+template <size_t SIZE>
+void compare(const better_bitset::HierarchicalBitSet<SIZE>& hbs,
+             const better_bitset::BitSet<SIZE>& bs, const char* step) {
+    if (hbs.first_one() != bs.first_one() ||
+        hbs.first_zero() != bs.first_zero() ||
+        hbs.all() != bs.all() ||
+        hbs.any() != bs.any() ||
+        hbs.none() != bs.none() ||
+        hbs.count() != bs.count()) {
+        std::cerr << "hbs.first_one()=" << hbs.first_one()
+                  << ", hbs.first_zero()=" << hbs.first_zero()
+                  << ", expected=" << bs.first_one() << "/" << bs.first_zero()
+                  << ", after " << step
+                  << ", size=" << SIZE
+                  << std::endl;
+        abort();
+    }
+}
+
+template <size_t SIZE>
+void runTest(std::default_random_engine& eng) {
+    auto hbs = std::make_unique<better_bitset::HierarchicalBitSet<SIZE>>();
+    auto bs = std::make_unique<better_bitset::BitSet<SIZE>>();
+    compare(*hbs, *bs, "construction");
+
+    // fill up from the bottom with some noise, then drain again, so that
+    // both scans move across every summary level. Only every STRIDE-th
+    // step is compared to keep the reference scans cheap for large sizes
+    constexpr size_t STRIDE = SIZE / 1024 + 1;
+    std::uniform_int_distribution<size_t> position(0, SIZE - 1);
+    for (bool value : { true, false }) {
+        for (size_t i = 0; i < SIZE; ++i) {
+            const size_t pos = value ? hbs->first_zero() : hbs->first_one();
+            if (pos == SIZE)
+                break;
+            hbs->set(pos, value);
+            bs->set(pos, value);
+            if (i % STRIDE == 0)
+                compare(*hbs, *bs, "scan");
+            const size_t noise = position(eng);
+            hbs->set(noise, !value);
+            bs->set(noise, !value);
+            if (i % STRIDE == 0)
+                compare(*hbs, *bs, "noise");
+        }
+    }
+
+    hbs->set();
+    bs->set();
+    compare(*hbs, *bs, "set()");
+    hbs->reset(position(eng));
+    hbs->flip();
+    bs->reset(hbs->first_one());
+    bs->flip();
+    compare(*hbs, *bs, "flip()");
+    hbs->reset();
+    bs->reset();
+    compare(*hbs, *bs, "reset()");
+
+    std::bernoulli_distribution b(0.5);
+    for (size_t i = 0; i < SIZE; ++i)
+        bs->set(i, b(eng));
+    *hbs = better_bitset::HierarchicalBitSet<SIZE>(*bs);
+    compare(*hbs, *bs, "copy");
+}
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    (runTest<SIZES>(eng), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 63, 64, 65, 129, 4095, 4096, 4097, 8192, 262145>(eng);
+
+    return 0;
+}
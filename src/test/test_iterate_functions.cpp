@@ -0,0 +1,87 @@
+
+#include <better_bitset.hpp>
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+template <size_t SIZE>
+void check(const std::vector<size_t>& actual, const std::vector<size_t>& expected,
+           const char* name, double density) {
+    constexpr size_t numChunks = (SIZE + 63) / 64;
+    if (actual != expected) {
+        std::cerr << name << " visited " << actual.size() << " positions"
+                  << ", expected=" << expected.size()
+                  << ", density=" << density
+                  << ", size=" << SIZE
+                  << ", NUM_CHUNKS=" << numChunks
+                  << std::endl;
+        abort();
+    }
+}
+
+template <size_t SIZE>
+void runTest(std::default_random_engine& eng) {
+    for (double density : { 0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0 }) {
+        std::bernoulli_distribution b(density);
+        better_bitset::BitSet<SIZE> bs;
+        for (size_t i = 0; i < SIZE; ++i)
+            bs.set(i, b(eng));
+
+        std::vector<size_t> expectedOnes;
+        std::vector<size_t> expectedZeros;
+        for (size_t i = 0; i < SIZE; ++i)
+            (bs.test(i) ? expectedOnes : expectedZeros).push_back(i);
+
+        std::vector<size_t> ones;
+        for (size_t pos : bs.ones())
+            ones.push_back(pos);
+        check<SIZE>(ones, expectedOnes, "bs.ones()", density);
+
+        std::vector<size_t> zeros;
+        for (size_t pos : bs.zeros())
+            zeros.push_back(pos);
+        check<SIZE>(zeros, expectedZeros, "bs.zeros()", density);
+
+        ones.clear();
+        bs.for_each_one([&](size_t pos) { ones.push_back(pos); });
+        check<SIZE>(ones, expectedOnes, "bs.for_each_one()", density);
+
+        zeros.clear();
+        bs.for_each_zero([&](size_t pos) { zeros.push_back(pos); });
+        check<SIZE>(zeros, expectedZeros, "bs.for_each_zero()", density);
+
+        // every capacity from truncating at the first position to spare room
+        for (size_t capacity : { size_t(0), expectedOnes.size() / 2, expectedOnes.size(), SIZE }) {
+            std::vector<uint32_t> indices(capacity);
+            indices.resize(bs.to_indices(indices));
+            ones.assign(indices.begin(), indices.end());
+            const std::vector<size_t> expected(expectedOnes.begin(),
+                expectedOnes.begin() + std::min(capacity, expectedOnes.size()));
+            check<SIZE>(ones, expected, "bs.to_indices()", density);
+        }
+    }
+}
+
+// the iteration ranges refer to the bitset, so taking them from a temporary
+// must not compile
+template <size_t SIZE>
+constexpr bool rangesFromTemporary = requires { better_bitset::BitSet<SIZE>{}.ones(); } ||
+                                     requires { better_bitset::BitSet<SIZE>{}.zeros(); };
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    static_assert(!(rangesFromTemporary<SIZES> || ...));
+    (runTest<SIZES>(eng), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 96, 127, 128, 129,
+             255, 256, 257, 1000, 1024, 8192>(eng);
+
+    return 0;
+}
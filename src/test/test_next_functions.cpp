@@ -0,0 +1,62 @@
+
+#include <better_bitset.hpp>
+
+#include <iostream>
+#include <random>
+
+
+template <size_t SIZE>
+void runTest(std::default_random_engine& eng) {
+    constexpr size_t numChunks = (SIZE + 63) / 64;
+    for (double density : { 0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0 }) {
+        std::bernoulli_distribution b(density);
+        better_bitset::BitSet<SIZE> bs;
+        for (size_t i = 0; i < SIZE; ++i)
+            bs.set(i, b(eng));
+
+        size_t expectedOne = SIZE;
+        size_t expectedZero = SIZE;
+        for (size_t pos = SIZE + 1; pos > 0; --pos) {
+            const size_t index = pos - 1;
+            if (index < SIZE) {
+                if (bs.test(index))
+                    expectedOne = index;
+                else
+                    expectedZero = index;
+            }
+            if (bs.find_next_one(index) != expectedOne) {
+                std::cerr << "bs.find_next_one(" << index << ")=" << bs.find_next_one(index)
+                          << ", expected=" << expectedOne
+                          << ", density=" << density
+                          << ", size=" << SIZE
+                          << ", NUM_CHUNKS=" << numChunks
+                          << std::endl;
+                abort();
+            }
+            if (bs.find_next_zero(index) != expectedZero) {
+                std::cerr << "bs.find_next_zero(" << index << ")=" << bs.find_next_zero(index)
+                          << ", expected=" << expectedZero
+                          << ", density=" << density
+                          << ", size=" << SIZE
+                          << ", NUM_CHUNKS=" << numChunks
+                          << std::endl;
+                abort();
+            }
+        }
+    }
+}
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    (runTest<SIZES>(eng), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 96, 127, 128, 129,
+             255, 256, 257, 1000, 1024, 8192>(eng);
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+
+#include <better_bitset.hpp>
+
+#include <iostream>
+#include <random>
+
+
+template <size_t SIZE, size_t PATTERN_SIZE>
+size_t findPattern(const better_bitset::BitSet<SIZE>& bs,
+                   const better_bitset::BitSet<PATTERN_SIZE>& pattern, size_t pos) {
+    for (size_t start = pos; start + PATTERN_SIZE <= SIZE; ++start) {
+        size_t bit = 0;
+        while (bit < PATTERN_SIZE && bs.test(start + bit) == pattern.test(bit))
+            ++bit;
+        if (bit == PATTERN_SIZE)
+            return start;
+    }
+    return SIZE;
+}
+
+template <size_t SIZE, size_t PATTERN_SIZE>
+void runPattern(std::default_random_engine& eng, const better_bitset::BitSet<SIZE>& bs, double density) {
+    constexpr size_t numChunks = (SIZE + 63) / 64;
+    std::uniform_int_distribution<size_t> position(0, SIZE);
+    std::bernoulli_distribution b(0.5);
+    for (size_t i = 0; i < 8; ++i) {
+        // half of the patterns are copied from the set so that they occur
+        better_bitset::BitSet<PATTERN_SIZE> pattern;
+        const size_t source = position(eng);
+        for (size_t bit = 0; bit < PATTERN_SIZE; ++bit) {
+            if (i % 2 == 0 && source + PATTERN_SIZE <= SIZE)
+                pattern.set(bit, bs.test(source + bit));
+            else
+                pattern.set(bit, b(eng));
+        }
+        const size_t pos = i < 4 ? 0 : position(eng);
+        const size_t actual = bs.find_pattern(pattern, pos);
+        const size_t expected = findPattern(bs, pattern, pos);
+        if (actual != expected) {
+            std::cerr << "bs.find_pattern(" << pattern.to_string() << ", " << pos << ")=" << actual
+                      << ", expected=" << expected
+                      << ", density=" << density
+                      << ", size=" << SIZE
+                      << ", NUM_CHUNKS=" << numChunks
+                      << std::endl;
+            abort();
+        }
+    }
+}
+
+template <size_t SIZE>
+void runTest(std::default_random_engine& eng) {
+    for (double density : { 0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0 }) {
+        std::bernoulli_distribution b(density);
+        better_bitset::BitSet<SIZE> bs;
+        for (size_t i = 0; i < SIZE; ++i)
+            bs.set(i, b(eng));
+
+        runPattern<SIZE, 1>(eng, bs, density);
+        runPattern<SIZE, 3>(eng, bs, density);
+        runPattern<SIZE, 12>(eng, bs, density);
+        runPattern<SIZE, 64>(eng, bs, density);
+        runPattern<SIZE, 65>(eng, bs, density);
+        runPattern<SIZE, 100>(eng, bs, density);
+    }
+}
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    (runTest<SIZES>(eng), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 96, 127, 128, 129,
+             255, 256, 257, 1000, 1024, 8192>(eng);
+
+    return 0;
+}
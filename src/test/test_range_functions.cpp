@@ -0,0 +1,87 @@
+
+#include <better_bitset.hpp>
+
+#include <iostream>
+#include <random>
+
+
+template <size_t SIZE>
+void runTest(std::default_random_engine& eng) {
+    constexpr size_t numChunks = (SIZE + 63) / 64;
+    std::uniform_int_distribution<size_t> position(0, SIZE);
+    for (double density : { 0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0 }) {
+        std::bernoulli_distribution b(density);
+        better_bitset::BitSet<SIZE> bs;
+        for (size_t i = 0; i < SIZE; ++i)
+            bs.set(i, b(eng));
+
+        for (size_t i = 0; i < 256; ++i) {
+            size_t lo = position(eng);
+            size_t hi = position(eng);
+            if (lo > hi)
+                std::swap(lo, hi);
+            for (bool value : { true, false }) {
+                const size_t actual = value ? bs.first_one_in(lo, hi) : bs.first_zero_in(lo, hi);
+                size_t expected = value ? bs.find_next_one(lo) : bs.find_next_zero(lo);
+                if (expected >= hi)
+                    expected = SIZE;
+                if (actual != expected) {
+                    std::cerr << (value ? "bs.first_one_in(" : "bs.first_zero_in(")
+                              << lo << ", " << hi << ")=" << actual
+                              << ", expected=" << expected
+                              << ", density=" << density
+                              << ", size=" << SIZE
+                              << ", NUM_CHUNKS=" << numChunks
+                              << std::endl;
+                    abort();
+                }
+            }
+            size_t expected = 0;
+            for (size_t pos = lo; pos < hi; ++pos)
+                expected += bs.test(pos);
+            if (bs.count_range(lo, hi) != expected) {
+                std::cerr << "bs.count_range(" << lo << ", " << hi << ")=" << bs.count_range(lo, hi)
+                          << ", expected=" << expected
+                          << ", density=" << density
+                          << ", size=" << SIZE
+                          << ", NUM_CHUNKS=" << numChunks
+                          << std::endl;
+                abort();
+            }
+            for (bool value : { true, false }) {
+                better_bitset::BitSet<SIZE> actualBs = bs;
+                better_bitset::BitSet<SIZE> expectedBs = bs;
+                if (value)
+                    actualBs.set_range(lo, hi - lo);
+                else
+                    actualBs.reset_range(lo, hi - lo);
+                for (size_t pos = lo; pos < hi; ++pos)
+                    expectedBs.set(pos, value);
+                if (!(actualBs == expectedBs)) {
+                    std::cerr << (value ? "bs.set_range(" : "bs.reset_range(")
+                              << lo << ", " << hi - lo << ") differs"
+                              << ", density=" << density
+                              << ", size=" << SIZE
+                              << ", NUM_CHUNKS=" << numChunks
+                              << std::endl;
+                    abort();
+                }
+            }
+        }
+    }
+}
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    (runTest<SIZES>(eng), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 96, 127, 128, 129,
+             255, 256, 257, 1000, 1024, 4096, 8192>(eng);
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+
+#include <better_bitset.hpp>
+#include <ranked_bitset.hpp>
+
+#include <iostream>
+#include <random>
+
+
+template <size_t SIZE>
+void check(const char* name, size_t pos, size_t actual, size_t expected, double density) {
+    constexpr size_t numChunks = (SIZE + 63) / 64;
+    if (actual != expected) {
+        std::cerr << name << "(" << pos << ")=" << actual
+                  << ", expected=" << expected
+                  << ", density=" << density
+                  << ", size=" << SIZE
+                  << ", NUM_CHUNKS=" << numChunks
+                  << std::endl;
+        abort();
+    }
+}
+
+template <size_t SIZE>
+void runTest(std::default_random_engine& eng) {
+    for (double density : { 0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0 }) {
+        std::bernoulli_distribution b(density);
+        better_bitset::BitSet<SIZE> bs;
+        for (size_t i = 0; i < SIZE; ++i)
+            bs.set(i, b(eng));
+        better_bitset::RankedBitSet<SIZE> rbs(bs);
+
+        size_t expected = 0;
+        for (size_t pos = 0; pos <= SIZE; ++pos) {
+            check<SIZE>("bs.rank", pos, bs.rank(pos), expected, density);
+            check<SIZE>("rbs.rank", pos, rbs.rank(pos), expected, density);
+            if (pos < SIZE && bs.test(pos))
+                ++expected;
+        }
+
+        // flip some bits and compare against the recomputed ranks
+        std::uniform_int_distribution<size_t> position(0, SIZE - 1);
+        for (size_t i = 0; i < 16; ++i) {
+            const size_t pos = position(eng);
+            rbs.set(pos, !rbs.test(pos));
+            bs.set(pos, !bs.test(pos));
+        }
+        for (size_t pos = 0; pos <= SIZE; ++pos)
+            check<SIZE>("rbs.rank", pos, rbs.rank(pos), bs.rank(pos), density);
+        check<SIZE>("rbs.count", SIZE, rbs.count(), bs.count(), density);
+    }
+}
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    (runTest<SIZES>(eng), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 96, 127, 128, 129,
+             255, 256, 257, 511, 512, 513, 1000, 1024, 8192>(eng);
+
+    return 0;
+}
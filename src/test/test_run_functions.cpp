@@ -0,0 +1,61 @@
+
+#include <better_bitset.hpp>
+
+#include <iostream>
+#include <random>
+
+
+template <size_t SIZE>
+size_t findRun(const better_bitset::BitSet<SIZE>& bs, bool value, size_t k) {
+    if (k == 0)
+        return 0;
+    size_t run = 0;
+    for (size_t i = 0; i < SIZE; ++i) {
+        run = bs.test(i) == value ? run + 1 : 0;
+        if (run >= k)
+            return i + 1 - k;
+    }
+    return SIZE;
+}
+
+template <size_t SIZE>
+void runTest(std::default_random_engine& eng) {
+    constexpr size_t numChunks = (SIZE + 63) / 64;
+    for (double density : { 0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0 }) {
+        std::bernoulli_distribution b(density);
+        better_bitset::BitSet<SIZE> bs;
+        for (size_t i = 0; i < SIZE; ++i)
+            bs.set(i, b(eng));
+
+        for (size_t k : { 0, 1, 2, 3, 5, 8, 13, 31, 32, 33, 63, 64, 65, 100, 128, 129, 200 }) {
+            for (bool value : { true, false }) {
+                const size_t actual = value ? bs.find_one_run(k) : bs.find_zero_run(k);
+                const size_t expected = findRun(bs, value, k);
+                if (actual != expected) {
+                    std::cerr << (value ? "bs.find_one_run(" : "bs.find_zero_run(") << k << ")=" << actual
+                              << ", expected=" << expected
+                              << ", density=" << density
+                              << ", size=" << SIZE
+                              << ", NUM_CHUNKS=" << numChunks
+                              << std::endl;
+                    abort();
+                }
+            }
+        }
+    }
+}
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    (runTest<SIZES>(eng), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 96, 127, 128, 129,
+             255, 256, 257, 1000, 1024, 8192>(eng);
+
+    return 0;
+}
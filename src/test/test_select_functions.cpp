@@ -0,0 +1,59 @@
+
+#include <better_bitset.hpp>
+
+#include <iostream>
+#include <random>
+
+
+template <size_t SIZE>
+void runTest(std::default_random_engine& eng) {
+    constexpr size_t numChunks = (SIZE + 63) / 64;
+    for (double density : { 0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0 }) {
+        std::bernoulli_distribution b(density);
+        better_bitset::BitSet<SIZE> bs;
+        for (size_t i = 0; i < SIZE; ++i)
+            bs.set(i, b(eng));
+
+        size_t ones = 0;
+        size_t zeros = 0;
+        for (size_t index = 0; index < SIZE; ++index) {
+            const bool value = bs.test(index);
+            const size_t k = value ? ones++ : zeros++;
+            const size_t actual = value ? bs.select_one(k) : bs.select_zero(k);
+            if (actual != index) {
+                std::cerr << (value ? "bs.select_one(" : "bs.select_zero(") << k << ")=" << actual
+                          << ", expected=" << index
+                          << ", density=" << density
+                          << ", size=" << SIZE
+                          << ", NUM_CHUNKS=" << numChunks
+                          << std::endl;
+                abort();
+            }
+        }
+        if (bs.select_one(ones) != SIZE || bs.select_zero(zeros) != SIZE) {
+            std::cerr << "bs.select_one(" << ones << ")=" << bs.select_one(ones)
+                      << ", bs.select_zero(" << zeros << ")=" << bs.select_zero(zeros)
+                      << ", expected=" << SIZE
+                      << ", density=" << density
+                      << ", size=" << SIZE
+                      << ", NUM_CHUNKS=" << numChunks
+                      << std::endl;
+            abort();
+        }
+    }
+}
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    (runTest<SIZES>(eng), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 96, 127, 128, 129,
+             255, 256, 257, 1000, 1024, 8192>(eng);
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+
+#include <bitset_kernels.hpp>
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+using SkipFunc = size_t (*)(const uint64_t*, size_t) noexcept;
+using MismatchFunc = size_t (*)(const uint64_t*, const uint64_t*, size_t) noexcept;
+using CountFunc = size_t (*)(const uint64_t*, size_t) noexcept;
+using IndicesFunc = size_t (*)(const uint64_t*, size_t, uint32_t*, size_t) noexcept;
+
+void checkSkip(const char* name, SkipFunc func, SkipFunc reference,
+               const std::vector<uint64_t>& chunks) {
+    const size_t actual = func(chunks.data(), chunks.size());
+    const size_t expected = reference(chunks.data(), chunks.size());
+    if (actual != expected) {
+        std::cerr << name << "=" << actual
+                  << ", expected=" << expected
+                  << ", size=" << chunks.size()
+                  << std::endl;
+        abort();
+    }
+}
+
+void checkMismatch(const char* name, MismatchFunc func, const std::vector<uint64_t>& chunks) {
+    // compares against a copy with one chunk changed at every position
+    std::vector<uint64_t> other = chunks;
+    for (size_t pos = 0; pos <= chunks.size(); ++pos) {
+        if (pos < chunks.size())
+            other[pos] = ~other[pos];
+        const size_t actual = func(chunks.data(), other.data(), chunks.size());
+        if (actual != pos) {
+            std::cerr << name << "=" << actual
+                      << ", expected=" << pos
+                      << ", size=" << chunks.size()
+                      << std::endl;
+            abort();
+        }
+        if (pos < chunks.size())
+            other[pos] = chunks[pos];
+    }
+}
+
+void checkCount(const char* name, CountFunc func, const std::vector<uint64_t>& chunks) {
+    const size_t actual = func(chunks.data(), chunks.size());
+    const size_t expected = better_bitset::detail::count_scalar(chunks.data(), chunks.size());
+    if (actual != expected) {
+        std::cerr << name << "=" << actual
+                  << ", expected=" << expected
+                  << ", size=" << chunks.size()
+                  << std::endl;
+        abort();
+    }
+}
+
+void checkIndices(const char* name, IndicesFunc func, const std::vector<uint64_t>& chunks) {
+    const size_t ones = better_bitset::detail::count_scalar(chunks.data(), chunks.size());
+    for (size_t capacity : { size_t(0), ones / 2, ones, ones + 64 }) {
+        std::vector<uint32_t> actual(capacity);
+        std::vector<uint32_t> expected(capacity);
+        actual.resize(func(chunks.data(), chunks.size(), actual.data(), capacity));
+        expected.resize(better_bitset::detail::to_indices_scalar(chunks.data(), chunks.size(),
+                                                                 expected.data(), capacity));
+        if (actual != expected) {
+            std::cerr << name << " wrote " << actual.size() << " positions"
+                      << ", expected=" << expected.size()
+                      << ", capacity=" << capacity
+                      << ", size=" << chunks.size()
+                      << std::endl;
+            abort();
+        }
+    }
+}
+
+void checkSelect(const char* name, size_t (*func)(uint64_t, size_t) noexcept, uint64_t word) {
+    for (size_t k = 0; k < static_cast<size_t>(std::popcount(word)); ++k) {
+        const size_t actual = func(word, k);
+        const size_t expected = better_bitset::detail::select_in_word_scalar(word, k);
+        if (actual != expected) {
+            std::cerr << name << "(" << word << ", " << k << ")=" << actual
+                      << ", expected=" << expected
+                      << std::endl;
+            abort();
+        }
+    }
+}
+
+void checkLowestOnes(uint64_t word) {
+    for (size_t count = 1; count <= 64; ++count) {
+        const uint64_t actual = better_bitset::detail::lowest_ones(word, count);
+        uint64_t expected = 0;
+        for (uint64_t rest = word; rest != 0 && static_cast<size_t>(std::popcount(expected)) < count; rest &= rest - 1)
+            expected |= rest & -rest;
+        if (actual != expected) {
+            std::cerr << "lowest_ones(" << word << ", " << count << ")=" << actual
+                      << ", expected=" << expected
+                      << std::endl;
+            abort();
+        }
+    }
+}
+
+void runTest(const std::vector<uint64_t>& chunks) {
+    using namespace better_bitset::detail;
+    const Kernels& selected = kernels();
+    checkSkip("kernels().skip_zeros", selected.skip_zeros, &skip_chunks_scalar<false>, chunks);
+    checkSkip("kernels().skip_ones", selected.skip_ones, &skip_chunks_scalar<true>, chunks);
+    for (uint64_t chunk : chunks)
+        checkSelect("kernels().select_in_word", selected.select_in_word, chunk);
+    for (uint64_t chunk : chunks)
+        checkLowestOnes(chunk);
+    checkMismatch("kernels().mismatch", selected.mismatch, chunks);
+    checkCount("kernels().count", selected.count, chunks);
+    checkIndices("kernels().to_indices", selected.to_indices, chunks);
+#if defined(BETTER_BITSET_DISPATCH)
+    if (__builtin_cpu_supports("bmi2")) {
+        for (uint64_t chunk : chunks)
+            checkSelect("select_in_word_bmi2", &select_in_word_bmi2, chunk);
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        checkSkip("skip_chunks_avx2<false>", &skip_chunks_avx2<false>, &skip_chunks_scalar<false>, chunks);
+        checkSkip("skip_chunks_avx2<true>", &skip_chunks_avx2<true>, &skip_chunks_scalar<true>, chunks);
+        checkMismatch("mismatch_avx2", &mismatch_avx2, chunks);
+        checkCount("count_avx2", &count_avx2, chunks);
+        checkIndices("to_indices_avx2", &to_indices_avx2, chunks);
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        checkSkip("skip_chunks_avx512<false>", &skip_chunks_avx512<false>, &skip_chunks_scalar<false>, chunks);
+        checkSkip("skip_chunks_avx512<true>", &skip_chunks_avx512<true>, &skip_chunks_scalar<true>, chunks);
+        checkMismatch("mismatch_avx512", &mismatch_avx512, chunks);
+        checkIndices("to_indices_avx512", &to_indices_avx512, chunks);
+    }
+    if (__builtin_cpu_supports("avx512bw"))
+        checkCount("count_avx512bw", &count_avx512bw, chunks);
+    if (__builtin_cpu_supports("avx512vpopcntdq"))
+        checkCount("count_avx512_vpopcntdq", &count_avx512_vpopcntdq, chunks);
+#endif
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    std::uniform_int_distribution<uint64_t> random;
+    for (size_t size = 0; size <= 40; ++size) {
+        for (uint64_t fill : { 0ull, ~0ull }) {
+            std::vector<uint64_t> chunks(size, fill);
+            runTest(chunks);
+            // a single differing chunk at every position
+            for (size_t pos = 0; pos < size; ++pos) {
+                chunks[pos] = random(eng);
+                runTest(chunks);
+                chunks[pos] = fill;
+            }
+        }
+        std::vector<uint64_t> chunks(size);
+        for (uint64_t& chunk : chunks)
+            chunk = random(eng);
+        runTest(chunks);
+    }
+
+    return 0;
+}
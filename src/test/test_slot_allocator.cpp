@@ -0,0 +1,135 @@
+
+#include <slot_allocator.hpp>
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+template <size_t SIZE, typename Handle_t>
+void fail(const char* name, size_t actual, size_t expected) {
+    std::cerr << name << "=" << actual
+              << ", expected=" << expected
+              << ", size=" << SIZE
+              << ", HANDLE_BITS=" << std::numeric_limits<Handle_t>::digits
+              << std::endl;
+    abort();
+}
+
+template <size_t SIZE, typename Handle_t>
+void runTest(std::default_random_engine& eng) {
+    using Allocator = better_bitset::SlotAllocator<SIZE, Handle_t>;
+    Allocator allocator;
+    std::vector<Handle_t> live;
+    std::vector<Handle_t> stale;
+    better_bitset::BitSet<SIZE> reference;
+
+    for (double claimChance : { 1.0, 0.9, 0.5, 0.1, 0.0 }) {
+        std::bernoulli_distribution claiming(claimChance);
+        for (size_t step = 0; step < 4 * SIZE + 64; ++step) {
+            if (claiming(eng)) {
+                const Handle_t handle = allocator.claim();
+                const size_t expected = reference.first_zero();
+                if (expected == SIZE) {
+                    if (handle != Allocator::INVALID)
+                        fail<SIZE, Handle_t>("allocator.claim() when full", handle, Allocator::INVALID);
+                    continue;
+                }
+                if (Allocator::index(handle) != expected)
+                    fail<SIZE, Handle_t>("Allocator::index(allocator.claim())", Allocator::index(handle), expected);
+                if (!allocator.validate(handle))
+                    fail<SIZE, Handle_t>("allocator.validate(claimed)", 0, 1);
+                reference.set(expected);
+                live.push_back(handle);
+            }
+            else if (!live.empty()) {
+                std::uniform_int_distribution<size_t> pick(0, live.size() - 1);
+                const size_t i = pick(eng);
+                const Handle_t handle = live[i];
+                live[i] = live.back();
+                live.pop_back();
+                if (!allocator.release(handle))
+                    fail<SIZE, Handle_t>("allocator.release(live)", 0, 1);
+                if (allocator.release(handle))
+                    fail<SIZE, Handle_t>("allocator.release(released)", 1, 0);
+                reference.reset(Allocator::index(handle));
+                stale.push_back(handle);
+            }
+            if (allocator.count() != reference.count())
+                fail<SIZE, Handle_t>("allocator.count()", allocator.count(), reference.count());
+        }
+        for (Handle_t handle : live) {
+            if (!allocator.validate(handle))
+                fail<SIZE, Handle_t>("allocator.validate(live)", 0, 1);
+        }
+    }
+    // stale handles stay invalid until the generation wraps around, which
+    // takes at least as many releases of the same slot
+    if constexpr (Allocator::GENERATION_BITS >= 16) {
+        for (Handle_t handle : stale) {
+            if (allocator.validate(handle))
+                fail<SIZE, Handle_t>("allocator.validate(stale)", 1, 0);
+        }
+    }
+    if (allocator.validate(Allocator::INVALID))
+        fail<SIZE, Handle_t>("allocator.validate(INVALID)", 1, 0);
+}
+
+// cycles a single slot through every generation
+template <size_t SIZE, typename Handle_t>
+void runWrapTest() {
+    using Allocator = better_bitset::SlotAllocator<SIZE, Handle_t>;
+    Allocator allocator;
+    const Handle_t first = allocator.claim();
+    Handle_t handle = first;
+    const size_t generations = (size_t(1) << Allocator::GENERATION_BITS) - 1;
+    for (size_t generation = 1; generation <= generations; ++generation) {
+        if (handle == Allocator::INVALID || !allocator.release(handle))
+            fail<SIZE, Handle_t>("allocator.release() at generation", generation, 0);
+        handle = allocator.claim();
+        // the all-ones generation is skipped
+        if ((handle == first) != (generation == generations))
+            fail<SIZE, Handle_t>("generation wrap", generation, generations);
+    }
+}
+
+// with the fewest generation bits, a handle must still go stale after one
+// reuse of its slot
+template <size_t SIZE, typename Handle_t>
+void runNarrowTest() {
+    using Allocator = better_bitset::SlotAllocator<SIZE, Handle_t>;
+    static_assert(Allocator::GENERATION_BITS == 2);
+    Allocator allocator;
+    const Handle_t stale = allocator.claim();
+    if (!allocator.release(stale))
+        fail<SIZE, Handle_t>("allocator.release(stale)", 0, 1);
+    const Handle_t handle = allocator.claim();
+    if (Allocator::index(handle) != Allocator::index(stale))
+        fail<SIZE, Handle_t>("Allocator::index(allocator.claim())", Allocator::index(handle), Allocator::index(stale));
+    if (allocator.validate(stale))
+        fail<SIZE, Handle_t>("allocator.validate(stale)", 1, 0);
+    if (!allocator.validate(handle))
+        fail<SIZE, Handle_t>("allocator.validate(claimed)", 0, 1);
+}
+
+template <size_t... SIZES>
+void runTests(std::default_random_engine& eng) {
+    (runTest<SIZES, uint64_t>(eng), ...);
+    (runTest<SIZES, uint32_t>(eng), ...);
+}
+
+
+int main() {
+
+    std::default_random_engine eng(42);
+    runTests<1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 96, 127, 128, 129,
+             255, 256, 257, 1000, 1024, 8192>(eng);
+    runTest<256, uint16_t>(eng);
+    runWrapTest<256, uint16_t>();
+    runWrapTest<1, uint8_t>();
+    runWrapTest<100, uint16_t>();
+    runNarrowTest<64, uint8_t>();
+    runNarrowTest<16384, uint16_t>();
+
+    return 0;
+}
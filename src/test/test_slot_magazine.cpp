@@ -0,0 +1,138 @@
+
+#include <atomic_bitset.hpp>
+#include <atomic_hierarchical_bitset.hpp>
+#include <slot_magazine.hpp>
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+constexpr size_t NUM_THREADS = 8;
+
+template <typename Shared_t, size_t CAPACITY>
+void fail(const char* name, size_t actual, size_t expected, const Shared_t& shared) {
+    std::cerr << name << "=" << actual
+              << ", expected=" << expected
+              << ", size=" << shared.size()
+              << ", CAPACITY=" << CAPACITY
+              << std::endl;
+    abort();
+}
+
+template <typename Shared_t, size_t CAPACITY>
+void runTest() {
+    using Magazine = better_bitset::SlotMagazine<Shared_t, CAPACITY>;
+    auto shared = std::make_unique<Shared_t>();
+    const size_t size = shared->size();
+
+    // claims from a fresh set are handed out lowest first, and draining
+    // returns everything released into the magazine
+    {
+        Magazine magazine(*shared);
+        const size_t claims = std::min<size_t>(size, 3 * CAPACITY + 5);
+        for (size_t i = 0; i < claims; ++i) {
+            const size_t pos = magazine.claim();
+            if (pos != i)
+                fail<Shared_t, CAPACITY>("magazine.claim()", pos, i, *shared);
+        }
+        for (size_t i = 0; i < claims; i += 2)
+            magazine.release(i);
+        if (magazine.size() > CAPACITY)
+            fail<Shared_t, CAPACITY>("magazine.size()", magazine.size(), CAPACITY, *shared);
+        magazine.drain();
+        if (magazine.size() != 0)
+            fail<Shared_t, CAPACITY>("magazine.size() after drain()", magazine.size(), 0, *shared);
+        if (shared->count() != claims / 2)
+            fail<Shared_t, CAPACITY>("shared.count() after drain()", shared->count(), claims / 2, *shared);
+        for (size_t i = 1; i < claims; i += 2)
+            magazine.release(i);
+    }
+    if (shared->count() != 0)
+        fail<Shared_t, CAPACITY>("shared.count() after destruction", shared->count(), 0, *shared);
+
+    // threads claim a few slots through their own magazine, check that
+    // nobody else owns them, and release them again
+    std::vector<std::atomic<size_t>> owners(size);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&shared, &owners, size, t] {
+            Magazine magazine(*shared);
+            std::vector<size_t> held;
+            for (size_t step = 0; step < 20000; ++step) {
+                const size_t pos = magazine.claim();
+                if (pos != size) {
+                    if (owners[pos].exchange(t + 1, std::memory_order_relaxed) != 0)
+                        fail<Shared_t, CAPACITY>("owned slot claimed", pos, size, *shared);
+                    held.push_back(pos);
+                }
+                if (pos == size || held.size() > step % 13) {
+                    for (size_t released : held) {
+                        owners[released].store(0, std::memory_order_relaxed);
+                        magazine.release(released);
+                    }
+                    held.clear();
+                }
+            }
+            for (size_t released : held) {
+                owners[released].store(0, std::memory_order_relaxed);
+                magazine.release(released);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    if (shared->count() != 0)
+        fail<Shared_t, CAPACITY>("shared.count() after churn", shared->count(), 0, *shared);
+
+    // every slot is claimed through exactly one magazine
+    std::vector<std::vector<size_t>> claimed(NUM_THREADS);
+    std::vector<std::unique_ptr<Magazine>> magazines;
+    threads.clear();
+    for (size_t t = 0; t < NUM_THREADS; ++t) {
+        magazines.push_back(std::make_unique<Magazine>(*shared));
+        threads.emplace_back([&magazine = *magazines.back(), &claims = claimed[t], size] {
+            for (size_t pos = magazine.claim(); pos != size; pos = magazine.claim())
+                claims.push_back(pos);
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    std::vector<bool> seen(size);
+    size_t total = 0;
+    for (const std::vector<size_t>& claims : claimed) {
+        for (size_t pos : claims) {
+            if (seen[pos])
+                fail<Shared_t, CAPACITY>("claimed twice", pos, size, *shared);
+            seen[pos] = true;
+            ++total;
+        }
+    }
+    if (total != size)
+        fail<Shared_t, CAPACITY>("claimed count", total, size, *shared);
+}
+
+template <size_t... SIZES>
+void runTests() {
+    (runTest<better_bitset::AtomicBitSet<SIZES>, 1>(), ...);
+    (runTest<better_bitset::AtomicBitSet<SIZES>, 16>(), ...);
+    (runTest<better_bitset::AtomicBitSet<SIZES>, 64>(), ...);
+    (runTest<better_bitset::AtomicBitSet<SIZES>, 100>(), ...);
+    (runTest<better_bitset::AtomicHierarchicalBitSet<SIZES>, 1>(), ...);
+    (runTest<better_bitset::AtomicHierarchicalBitSet<SIZES>, 16>(), ...);
+    (runTest<better_bitset::AtomicHierarchicalBitSet<SIZES>, 64>(), ...);
+    (runTest<better_bitset::AtomicHierarchicalBitSet<SIZES>, 100>(), ...);
+}
+
+
+int main() {
+
+    runTests<1, 2, 7, 63, 64, 65, 129, 257, 1000, 8192>();
+    // scanning the flat set is too slow for filling this size one by one
+    runTest<better_bitset::AtomicHierarchicalBitSet<262145>, 1>();
+    runTest<better_bitset::AtomicHierarchicalBitSet<262145>, 64>();
+
+    return 0;
+}